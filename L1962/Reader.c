@@ -0,0 +1,300 @@
+//
+//  Reader.c
+//      Incremental reader, parses SExprs from input that may arrive in pieces
+//  L1962
+//
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "Reader.h"
+
+#define READER_CHUNK 65536 // Bytes asked of the fd per read
+
+void readerInit(Reader *reader) {
+    reader->capacity = 4096;
+    reader->data = malloc(reader->capacity);
+    reader->start = 0;
+    reader->end = 0;
+    reader->eof = 0;
+    reader->fd = -1;
+    reader->stack = NULL;
+    reader->depth = 0;
+    reader->stackCapacity = 0;
+}
+
+void readerInitFd(Reader *reader, int fd) {
+    readerInit(reader);
+    reader->fd = fd;
+}
+
+void readerInitString(Reader *reader, const char *str) {
+    readerInit(reader);
+    readerFeed(reader, str, strlen(str));
+    readerFinish(reader);
+}
+
+void readerFree(Reader *reader) {
+    free(reader->data);
+    free(reader->stack);
+    reader->data = NULL;
+    reader->stack = NULL;
+    reader->start = reader->end = reader->capacity = 0;
+    reader->depth = reader->stackCapacity = 0;
+}
+
+/**
+    Makes room for n more bytes at the end of the buffer, first dropping what has been read (private)
+ @param reader The reader
+ @param n The number of bytes needed
+ */
+static void readerReserve(Reader *reader, size_t n) {
+    if (reader->start > 0) {
+        memmove(reader->data, reader->data + reader->start, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->start = 0;
+    }
+    if (reader->end + n > reader->capacity) {
+        while (reader->end + n > reader->capacity) {
+            reader->capacity *= 2;
+        }
+        reader->data = realloc(reader->data, reader->capacity);
+    }
+}
+
+void readerFeed(Reader *reader, const char *data, size_t length) {
+    readerReserve(reader, length);
+    memcpy(reader->data + reader->end, data, length);
+    reader->end += length;
+}
+
+void readerFinish(Reader *reader) {
+    reader->eof = 1;
+}
+
+/**
+    Reads whatever the fd has ready into the buffer, blocking until there is some (private)
+ @param reader The reader
+ */
+static void readerFill(Reader *reader) {
+    readerReserve(reader, READER_CHUNK);
+    ssize_t n;
+    do {
+        n = read(reader->fd, reader->data + reader->end, reader->capacity - reader->end);
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        fail("read failed: %s", strerror(errno));
+    } else if (n == 0) {
+        reader->eof = 1;
+    } else {
+        reader->end += n;
+    }
+}
+
+/**
+    Abandons a partly parsed SExpr, so reading after a failure starts fresh with the next token (private)
+ @param reader The reader
+ */
+static void readerReset(Reader *reader) {
+    reader->depth = 0;
+}
+
+/**
+    Pushes a frame onto the parse stack (private)
+ @param reader The reader
+ @param wrap The quoting symbol, NULL for a list
+ @param close The list's closing token
+ */
+static void readerPush(Reader *reader, const char *wrap, TokenType close) {
+    if (reader->depth == reader->stackCapacity) {
+        reader->stackCapacity = (reader->stackCapacity == 0) ? 16 : reader->stackCapacity * 2;
+        reader->stack = realloc(reader->stack, reader->stackCapacity * sizeof(ReaderFrame));
+    }
+    ReaderFrame *frame = &reader->stack[reader->depth];
+    frame->wrap = wrap;
+    frame->close = close;
+    frame->head = NILObj;
+    frame->last = NILObj;
+    frame->dotted = 0;
+    reader->depth++;
+}
+
+/**
+    Hands a finished SExpr to the frame waiting for it, closing quote frames on the way (private)
+ @param reader The reader
+ @param value The finished SExpr
+ @param expr Set to the value when it is a top level SExpr
+ @return True if a top level SExpr is finished
+ */
+static int readerDeliver(Reader *reader, SExpr value, SExpr *expr) {
+    while (reader->depth > 0) {
+        ReaderFrame *top = &reader->stack[reader->depth - 1];
+        if (top->wrap != NULL) {
+            value = consToSExpr(symbolToSExpr(top->wrap), consToSExpr(value, NILObj));
+            reader->depth--;
+        } else if (top->dotted == 1) {
+            top->last.cons->cdr = value;
+            top->dotted = 2;
+            return 0;
+        } else {
+            SExpr cell = consToSExpr(value, NILObj);
+            if (isNIL(top->head)) {
+                top->head = cell;
+            } else {
+                top->last.cons->cdr = cell;
+            }
+            top->last = cell;
+            return 0;
+        }
+    }
+    *expr = value;
+    return 1;
+}
+
+/**
+    Advances the parse by one token (private)
+ @param reader The reader
+ @param token The token
+ @param expr Set to the SExpr when one is finished
+ @return True if a top level SExpr is finished
+ */
+static int readerToken(Reader *reader, Token token, SExpr *expr) {
+    ReaderFrame *top = (reader->depth > 0) ? &reader->stack[reader->depth - 1] : NULL;
+    if (top != NULL && top->dotted == 2 && token.type != top->close) { // Only the close may follow a dotted cdr
+        readerReset(reader);
+        if (token.type == TOKEN_CLOSEP || token.type == TOKEN_CLOSEB) {
+            fail("Incorrect closing character");
+        }
+        fail("Invalid Token of type: %s instead of CLOSE P", tokenName(token.type));
+    }
+    
+    SExpr value;
+    switch (token.type) {
+        case TOKEN_END:
+            if (reader->depth > 0) {
+                readerReset(reader);
+                fail("Early EOF");
+            }
+            expr->type = END;
+            return 1;
+            
+        case TOKEN_SYMBOL:
+            value = symbolToSExpr(token.value.s);
+            break;
+            
+        case TOKEN_INT:
+            value = intToSExpr(token.value.i);
+            break;
+            
+        case TOKEN_REAL:
+            value = realToSExpr(token.value.r);
+            break;
+            
+        case TOKEN_STRING:
+            value = stringToSExpr(token.value.str); // Copied behind a length header
+            free((char *) token.value.str);
+            break;
+            
+        case TOKEN_CHAR:
+            value = charToSExpr(token.value.c);
+            break;
+            
+        case TOKEN_OPENP:
+            readerPush(reader, NULL, TOKEN_CLOSEP);
+            return 0;
+            
+        case TOKEN_OPENB:
+            readerPush(reader, NULL, TOKEN_CLOSEB);
+            return 0;
+            
+        case TOKEN_QUOTE:
+            readerPush(reader, sym_QUOTE, TOKEN_END);
+            return 0;
+            
+        case TOKEN_BQUOTE:
+            readerPush(reader, sym_BQUOTE, TOKEN_END);
+            return 0;
+            
+        case TOKEN_COMMA:
+            readerPush(reader, sym_COMMA, TOKEN_END);
+            return 0;
+            
+        case TOKEN_CLOSEP:
+        case TOKEN_CLOSEB:
+            if (top == NULL || top->wrap != NULL || top->dotted == 1) {
+                readerReset(reader);
+                fail("Default Error, Not of Valid Token Type");
+            }
+            if (token.type != top->close) {
+                readerReset(reader);
+                fail("Incorrect closing character");
+            }
+            value = top->head;
+            reader->depth--;
+            break;
+            
+        case TOKEN_DOT:
+            if (top == NULL || top->wrap != NULL || top->dotted != 0 || isNIL(top->head)) {
+                readerReset(reader);
+                fail("Default Error, Not of Valid Token Type");
+            }
+            top->dotted = 1;
+            return 0;
+            
+        default:
+            readerReset(reader);
+            fail((token.value.e == '"') ? "Unterminated string" : "Poorly Formatted Character");
+    }
+    return readerDeliver(reader, value, expr);
+}
+
+ReaderStatus readerNext(Reader *reader, SExpr *expr) {
+    while (1) {
+        Token token;
+        size_t used;
+        int found = scanToken(reader->data + reader->start, reader->end - reader->start, reader->eof, &token, &used);
+        reader->start += used;
+        if (!found) {
+            if (reader->fd < 0) {
+                return READER_NEED_MORE;
+            }
+            readerFill(reader);
+        } else if (readerToken(reader, token, expr)) {
+            return (expr->type == END) ? READER_EOF : READER_OK;
+        }
+    }
+}
+
+int readerChar(Reader *reader) {
+    while (reader->start == reader->end) {
+        if (reader->eof || reader->fd < 0) {
+            return EOF;
+        }
+        readerFill(reader);
+    }
+    return (unsigned char) reader->data[reader->start++];
+}
+
+int readerLine(Reader *reader, Buffer *line) {
+    int found = 0;
+    while (1) {
+        const char *start = reader->data + reader->start;
+        size_t available = reader->end - reader->start;
+        const char *newline = memchr(start, '\n', available);
+        if (newline != NULL) {
+            bufferAppend(line, start, newline - start);
+            reader->start += newline - start + 1;
+            return 1;
+        }
+        if (available > 0) {
+            bufferAppend(line, start, available);
+            reader->start = reader->end;
+            found = 1;
+        }
+        if (reader->eof || reader->fd < 0) {
+            return found;
+        }
+        readerFill(reader);
+    }
+}
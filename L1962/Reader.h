@@ -0,0 +1,116 @@
+//
+//  Reader.h
+//      Incremental reader, parses SExprs from input that may arrive in pieces
+//  L1962
+//
+
+#ifndef Reader_h
+#define Reader_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "SExpr.h"
+
+/**
+    ReaderStatus Enum, the result of asking a reader for its next SExpr
+ */
+typedef enum ReaderStatus {
+    READER_OK,          // An SExpr was read
+    READER_NEED_MORE,   // The input so far ends partway through an SExpr, feed more and ask again
+    READER_EOF,         // The input is finished
+} ReaderStatus;
+
+/**
+    ReaderFrame Struct, an open list or a pending quote on the reader's parse stack
+ */
+typedef struct ReaderFrame ReaderFrame;
+struct ReaderFrame {
+    const char *wrap;   // Quote, backquote or comma symbol waiting for its SExpr, NULL for a list
+    TokenType close;    // Expected closing token
+    SExpr head;         // List read so far
+    SExpr last;         // Last cons of head
+    int dotted;         // 1 after the dot, 2 once the cdr has been read
+};
+
+/**
+    Reader Struct, buffered input plus the state of a partly parsed SExpr
+    Nothing is kept outside the struct, so a reader can be suspended whenever its input runs dry and any number can be used at once
+ */
+typedef struct Reader Reader;
+struct Reader {
+    char *data;
+    size_t start;       // First unread character
+    size_t end;         // End of buffered input
+    size_t capacity;
+    int eof;            // No more input will arrive
+    int fd;             // Source read when the buffer runs dry, -1 if input is fed
+    ReaderFrame *stack;
+    size_t depth;
+    size_t stackCapacity;
+};
+
+/**
+    Initializes a reader that is fed input with readerFeed
+ @param reader The reader
+ */
+void readerInit(Reader *reader);
+
+/**
+    Initializes a reader that reads from a file descriptor as needed
+ @param reader The reader
+ @param fd The file descriptor, which stays open when the reader is freed
+ */
+void readerInitFd(Reader *reader, int fd);
+
+/**
+    Initializes a reader over a complete string
+ @param reader The reader
+ @param str The string, which is copied
+ */
+void readerInitString(Reader *reader, const char *str);
+
+/**
+    Frees the storage of a reader
+ @param reader The reader
+ */
+void readerFree(Reader *reader);
+
+/**
+    Adds input to the end of a reader's buffer
+ @param reader The reader
+ @param data The input
+ @param length The number of bytes in data
+ */
+void readerFeed(Reader *reader, const char *data, size_t length);
+
+/**
+    Marks the end of a fed reader's input
+ @param reader The reader
+ */
+void readerFinish(Reader *reader);
+
+/**
+    Reads the next SExpr, resuming any SExpr left unfinished by the last call
+    A reader with an fd reads until it has an SExpr or the fd ends, so it never returns READER_NEED_MORE
+ @param reader The reader
+ @param expr Set to the SExpr on READER_OK, an END SExpr on READER_EOF
+ @return The status
+ */
+ReaderStatus readerNext(Reader *reader, SExpr *expr);
+
+/**
+    Reads one character, sharing the buffer with readerNext so the two can be mixed
+ @param reader The reader
+ @return The character, or EOF when none is buffered and none can be read
+ */
+int readerChar(Reader *reader);
+
+/**
+    Reads up to the next newline, scanning whole buffered blocks at a time
+ @param reader The reader
+ @param line The buffer the line is appended to, without its newline
+ @return True if a line was read, false at EOF
+ */
+int readerLine(Reader *reader, Buffer *line);
+
+#endif /* Reader_h */
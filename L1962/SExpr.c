@@ -9,6 +9,7 @@
 #include <stdio.h>
 
 #include "SExpr.h"
+#include "pointerMap.h"
 
 /**
     Duplication
@@ -21,6 +22,24 @@ extern inline int isSYMBOL(SExpr c);
 
 extern inline int isLIST(SExpr c);
 
+extern inline size_t stringLength(SExpr c);
+
+extern inline SExpr uncheckedCar(SExpr c);
+
+extern inline SExpr uncheckedCdr(SExpr c);
+
+extern inline SExpr car(SExpr c);
+
+extern inline SExpr cdr(SExpr c);
+
+extern inline SExpr cadr(SExpr c);
+
+extern inline SExpr caar(SExpr c);
+
+extern inline SExpr cdar(SExpr c);
+
+extern inline SExpr cddr(SExpr c);
+
 const SExpr NILObj  = { NIL };
 SExpr TObj  = { SYMBOL };
 
@@ -39,9 +58,19 @@ const char *sym_UNLESS = NULL;
 const char *sym_AND = NULL;
 const char *sym_OR = NULL;
 const char *sym_LET = NULL;
+const char *sym_LETStar = NULL;
 const char *sym_PROGN = NULL;
 const char *sym_BEGIN = NULL;
 const char *sym_APPLY = NULL;
+const char *sym_MACRO = NULL;
+const char *sym_DEFMACRO = NULL;
+const char *sym_FUTURE = NULL;
+const char *sym_WHILE = NULL;
+const char *sym_DO = NULL;
+const char *sym_DOTIMES = NULL;
+const char *sym_DOLIST = NULL;
+const char *sym_DEFSTRUCT = NULL;
+const char *sym_DEFINE_RECORD_TYPE = NULL;
 
 
 void SExprInit(void) {
@@ -60,85 +89,176 @@ void SExprInit(void) {
     sym_AND = struniq("and");
     sym_OR = struniq("or");
     sym_LET = struniq("let");
+    sym_LETStar = struniq("let*");
     sym_PROGN = struniq("progn");
     sym_BEGIN = struniq("begin");
     sym_APPLY = struniq("apply");
     sym_MACRO = struniq("macro");
+    sym_DEFMACRO = struniq("defmacro");
+    sym_FUTURE = struniq("future");
+    sym_WHILE = struniq("while");
+    sym_DO = struniq("do");
+    sym_DOTIMES = struniq("dotimes");
+    sym_DOLIST = struniq("dolist");
+    sym_DEFSTRUCT = struniq("defstruct");
+    sym_DEFINE_RECORD_TYPE = struniq("define-record-type");
     
     TObj.symbol = struniq("true");
 }
 
-SExpr eq(SExpr a, SExpr b) {
-    if(a.type == b.type) {
+int identical(SExpr a, SExpr b) {
+    if (a.type != b.type) {
+        return 0;
+    }
+    switch (a.type) {
+        case NIL:
+        case END:
+            return 1;
+            
+        case INT:
+            return a.i == b.i;
+            
+        case REAL:
+            return memcmp(&a.r, &b.r, sizeof(double)) == 0;
+            
+        case CHAR:
+            return a.c == b.c;
+            
+        case SYMBOL:
+            return a.symbol == b.symbol;
+            
+        case STRING:
+            return a.string == b.string;
+            
+        case CONS:
+            return a.cons == b.cons;
+            
+        case LAMBDA:
+        case MACRO:
+            return a.lambda == b.lambda;
+            
+        case BUILTIN:
+            return a.builtin.apply == b.builtin.apply;
+            
+        case FUTURE:
+            return a.future == b.future;
+            
+        case PORT:
+            return a.port == b.port;
+            
+        case RECORD:
+            return a.record == b.record;
+            
+        case F64VECTOR:
+        case S64VECTOR:
+            return a.vector == b.vector;
+            
+        case BYTEVECTOR:
+            return a.bytes == b.bytes;
+            
+        default:
+            return 0;
+    }
+}
+
+SExpr eqp(SExpr a, SExpr b) {
+    return identical(a, b) ? TObj : NILObj;
+}
+
+SExpr eqvp(SExpr a, SExpr b) {
+    if (identical(a, b) || (a.type == REAL && b.type == REAL && a.r == b.r)) {
+        return TObj;
+    }
+    return NILObj;
+}
+
+/**
+    Structural equality of two SExprs that are not both CONS (private)
+ @param a The first SExpr
+ @param b The second SExpr
+ @return 1 if equal
+ */
+static int equalAtom(SExpr a, SExpr b) {
+    if (a.type == b.type) {
         switch (a.type) {
-            case INT:
-                if (a.i == b.i) {
-                    return TObj;
-                }
-                break;
-                
             case REAL:
-                if (a.r == b.r) {
-                    return TObj;
-                }
-                break;
+                return a.r == b.r;
                 
-            case SYMBOL:
-                if (a.symbol == b.symbol) {
-                    return TObj;
-                }
-                break;
+            case STRING:
+            case BYTEVECTOR:
+                return a.string == b.string || (stringLength(a) == stringLength(b) && memcmp(a.string, b.string, stringLength(a)) == 0);
                 
-            case NIL:
-                return TObj;
-            
             case LAMBDA:
-            {
-                SExpr params = eq(a.lambda->params, b.lambda->params);
-                SExpr exprs = eq(a.lambda->exprs, b.lambda->exprs);
-                if (!isNIL(params) && (!isNIL(exprs))) {
-                    return TObj;
-                }
-            }
-                
-            case BUILTIN:
-                if (a.builtin.apply == b.builtin.apply) {
-                    return TObj;
-                }
+                return a.lambda == b.lambda || (!isNIL(eq(a.lambda->params, b.lambda->params)) && !isNIL(eq(a.lambda->exprs, b.lambda->exprs)));
                 
-            case CONS: // Needs some work
-            {
-                SExpr firstRes = eq(car(a), car(b));
-                SExpr restRes = eq(cdr(a), cdr(b));
-                
-                if (!isNIL(firstRes) && (!isNIL(restRes))) {
-                    return TObj;
+            case F64VECTOR:
+                if (a.vector->length != b.vector->length) {
+                    return 0;
                 }
-            }
-                
-            case STRING:
-                if (strcmp(a.string, b.string) == 0) {
-                    return TObj;
+                for (size_t i = 0; i < a.vector->length; i++) {
+                    if (a.vector->f64[i] != b.vector->f64[i]) {
+                        return 0;
+                    }
                 }
+                return 1;
                 
-            case CHAR:
-                if (a.c == b.c) {
-                    return TObj;
-                }
+            case S64VECTOR:
+                return a.vector->length == b.vector->length && memcmp(a.vector->s64, b.vector->s64, a.vector->length * sizeof(int64_t)) == 0;
                 
             default:
-                break;
+                return identical(a, b);
         }
     } else if (a.type == INT && b.type == REAL) {
-        if ((double) a.i == b.r) {
-            return TObj;
-        }
+        return (double) a.i == b.r;
     } else if (a.type == REAL && b.type == INT) {
-        if (a.r == (double) b.i) {
-            return TObj;
+        return a.r == (double) b.i;
+    }
+    return 0;
+}
+
+SExpr eq(SExpr a, SExpr b) {
+    if (!isCONS(a) || !isCONS(b)) { // Atoms never need the stack
+        return equalAtom(a, b) ? TObj : NILObj;
+    }
+    size_t count = 0;
+    size_t capacity = 0;
+    SExpr *stack = NULL; // Pairs of nested lists in car position still to compare
+    int equal = 1;
+    for (;;) {
+        // Walk the spines together, comparing atoms in place and saving nested lists for later
+        while (equal && isCONS(a) && isCONS(b)) {
+            if (a.cons != b.cons) {
+                SExpr carA = uncheckedCar(a);
+                SExpr carB = uncheckedCar(b);
+                if (isCONS(carA) && isCONS(carB)) {
+                    if (carA.cons != carB.cons) {
+                        if (count + 2 > capacity) {
+                            capacity = (capacity == 0) ? 32 : capacity * 2;
+                            stack = realloc(stack, capacity * sizeof(SExpr));
+                        }
+                        stack[count++] = carA;
+                        stack[count++] = carB;
+                    }
+                } else {
+                    equal = equalAtom(carA, carB);
+                }
+                a = uncheckedCdr(a);
+                b = uncheckedCdr(b);
+            } else {
+                a = b = NILObj; // Same list from here on
+            }
         }
+        if (equal && !(isCONS(a) && isCONS(b))) {
+            equal = equalAtom(a, b);
+        }
+        if (!equal || count == 0) {
+            break;
+        }
+        b = stack[--count];
+        a = stack[--count];
     }
-    return NILObj;
+    free(stack);
+    return equal ? TObj : NILObj;
 }
 
 Cons *makeCons(SExpr car, SExpr cdr) {
@@ -162,6 +282,7 @@ Lambda *makeLambda(SExpr params, SExpr exprs, SExpr env) {
     lambda->params = params;
     lambda->exprs = exprs;
     lambda->env = env;
+    lambda->code = NULL;
     return lambda;
 }
 
@@ -172,7 +293,7 @@ SExpr lambdaToSExpr(SExpr params, SExpr exprs, SExpr env) {
     return expr;
 }
 
-SExpr makeBuiltin(SExpr (*apply)(SExpr args)) {
+SExpr makeBuiltin(SExpr (*apply)(int argc, SExpr *argv)) {
     SExpr expr;
     expr.type = BUILTIN;
     expr.builtin.apply = apply;
@@ -214,9 +335,41 @@ SExpr makeNIL(void) {
 }
 
 SExpr stringToSExpr(const char* str) {
+    return stringToSExprLength(str, strlen(str));
+}
+
+char *allocString(size_t length) {
+    size_t *header = malloc(sizeof(size_t) + length + 1);
+    if (header == NULL) {
+        return NULL;
+    }
+    *header = length;
+    char *bytes = (char *) (header + 1);
+    bytes[length] = 0;
+    return bytes;
+}
+
+SExpr stringToSExprLength(const char *bytes, size_t length) {
+    char *string = allocString(length);
+    if (length > 0) {
+        memcpy(string, bytes, length);
+    }
     SExpr expr;
     expr.type = STRING;
-    expr.string = strdup(str);
+    expr.string = string;
+    return expr;
+}
+
+SExpr bytevectorToSExpr(const uint8_t *bytes, size_t length) {
+    char *storage = allocString(length);
+    if (bytes != NULL && length > 0) {
+        memcpy(storage, bytes, length);
+    } else {
+        memset(storage, 0, length);
+    }
+    SExpr expr;
+    expr.type = BYTEVECTOR;
+    expr.bytes = (uint8_t *) storage;
     return expr;
 }
 
@@ -242,6 +395,7 @@ void printSExprDepth(SExpr expr, int depth) {
             break;
         
         case LAMBDA:
+        case MACRO:
             printf("Params:\t");
             printSExpr(expr.lambda->params);
             printf("\nExprs:\t");
@@ -280,89 +434,365 @@ void debugSExpr(SExpr expr) {
 }
 
 /**
- Prints Cons SExpr (private)
- @param expr The Cons SExpr to print
+ Writes a char in #\\ form (private)
+ @param buffer The buffer to write to
+ @param c The char to write
  */
-void printCons(SExpr expr) {
-    printf("(");
-    while (expr.type != NIL) {
-        printSExpr(expr.cons->car);
-        if (expr.cons->cdr.type != NIL) {
-            printf(" ");
-            if (expr.cons->cdr.type != CONS) {
-                printf(". ");
-                printSExpr(expr.cons->cdr);
-                break;
-            }
-        }
-        expr = expr.cons->cdr;
+static void writeChar(Buffer *buffer, unsigned char c) {
+    bufferAppend(buffer, "#\\", 2);
+    const char *name = charName(c);
+    if (name != NULL) {
+        bufferString(buffer, name);
+    } else if (isprint(c)) {
+        bufferChar(buffer, c);
+    } else {
+        char octal[3] = { '0' + ((c >> 6) & 7), '0' + ((c >> 3) & 7), '0' + (c & 7) };
+        bufferAppend(buffer, octal, 3);
     }
-    printf(")");
 }
 
 /**
- Prints lambda SExpr (private)
- @param expr The lambda SExpr to print
+ Writes an object that has no readable form as <name pointer> (private)
+ @param buffer The buffer to write to
+ @param name The kind of object
+ @param pointer Its address
  */
-void printLambda(SExpr expr) {
-    printf("LAMBDA: Params: ");
-    printSExpr(expr.lambda->params);
-    printf("\tExprs: ");
-    printSExpr(expr.lambda->exprs);
+static void writeOpaque(Buffer *buffer, const char *name, const void *pointer) {
+    char text[64];
+    int n = snprintf(text, sizeof(text), "<%s %p>", name, pointer);
+    bufferAppend(buffer, text, n);
 }
 
 /**
- Prints builtin SExpr (private)
- @param expr The builtin SExpr to print
+ Writes a string in double quotes, escaping quotes and backslashes (private)
+ @param buffer The buffer to write to
+ @param str The string to write
  */
-void printBuiltin(SExpr expr) {
-    printf("<builtin %p>", expr.builtin.apply);
+static void writeQuotedString(Buffer *buffer, const char *str, size_t length) {
+    bufferChar(buffer, '"');
+    const char *run = str;
+    const char *end = str + length;
+    for (const char *p = str; p < end; p++) {
+        if (*p == '"' || *p == '\\') {
+            bufferAppend(buffer, run, p - run);
+            bufferChar(buffer, '\\');
+            run = p;
+        }
+    }
+    bufferAppend(buffer, run, end - run);
+    bufferChar(buffer, '"');
 }
 
-void printSExpr(SExpr expr) {
+/**
+ Writes an SExpr that contains no other SExprs (private)
+ @param buffer The buffer to write to
+ @param expr The SExpr to write
+ @param quoted Write strings in quotes
+ */
+static void writeAtom(Buffer *buffer, SExpr expr, int quoted) {
     switch (expr.type) {
         case NIL:
-            printf("NIL");
-            break;
-            
-        case CONS:
-            printCons(expr);
-            break;
-            
-        case LAMBDA:
-            printLambda(expr);
+            bufferAppend(buffer, "NIL", 3);
             break;
             
         case BUILTIN:
-            printBuiltin(expr);
+            writeOpaque(buffer, "builtin", (const void *) expr.builtin.apply);
             break;
             
         case SYMBOL:
-            printf("%s", expr.symbol);
+            bufferString(buffer, expr.symbol);
             break;
             
         case INT:
-            printf("%lld", expr.i);
+            bufferInt(buffer, expr.i);
             break;
             
         case REAL:
-            printf("%f", expr.r);
+            bufferReal(buffer, expr.r);
             break;
             
         case STRING:
-            printf("%s", expr.string);
+            if (quoted) {
+                writeQuotedString(buffer, expr.string, stringLength(expr));
+            } else {
+                bufferAppend(buffer, expr.string, stringLength(expr));
+            }
             break;
             
         case CHAR:
-            printChar(expr.c);
+            writeChar(buffer, expr.c);
+            break;
+            
+        case FUTURE:
+            writeOpaque(buffer, "future", (const void *) expr.future);
+            break;
+            
+        case PORT:
+            writeOpaque(buffer, "port", (const void *) expr.port);
+            break;
+            
+        case END:
+            bufferString(buffer, "#<eof>");
+            break;
+            
+        case F64VECTOR:
+            bufferString(buffer, "#f64(");
+            for (size_t i = 0; i < expr.vector->length; i++) {
+                if (i > 0) {
+                    bufferChar(buffer, ' ');
+                }
+                bufferReal(buffer, expr.vector->f64[i]);
+            }
+            bufferChar(buffer, ')');
+            break;
+            
+        case BYTEVECTOR:
+            bufferString(buffer, "#u8(");
+            for (size_t i = 0; i < stringLength(expr); i++) {
+                if (i > 0) {
+                    bufferChar(buffer, ' ');
+                }
+                bufferInt(buffer, expr.bytes[i]);
+            }
+            bufferChar(buffer, ')');
+            break;
+            
+        case S64VECTOR:
+            bufferString(buffer, "#s64(");
+            for (size_t i = 0; i < expr.vector->length; i++) {
+                if (i > 0) {
+                    bufferChar(buffer, ' ');
+                }
+                bufferInt(buffer, expr.vector->s64[i]);
+            }
+            bufferChar(buffer, ')');
             break;
             
         default:
-            printf("");
             break;
     }
 }
 
+/**
+ The address that identifies a CONS, LAMBDA, MACRO or RECORD for sharing, NULL for everything else (private)
+ @param expr The SExpr
+ @return The address or NULL
+ */
+static const void *sharedAddress(SExpr expr) {
+    if (expr.type == CONS) {
+        return expr.cons;
+    } else if (expr.type == LAMBDA || expr.type == MACRO) {
+        return expr.lambda;
+    } else if (expr.type == RECORD) {
+        return expr.record;
+    }
+    return NULL;
+}
+
+#define PRINT_SEEN 0    // Reached once
+#define PRINT_SHARED 1  // Reached more than once, needs a label
+#define PRINT_LABEL 2   // Labels are stored as PRINT_LABEL + n once #n= has been written
+
+/**
+ Finds every CONS, LAMBDA and RECORD reachable more than once (shared or cyclic) with an explicit stack (private)
+ @param shared The map to fill, address -> PRINT_SEEN or PRINT_SHARED
+ @param root The SExpr about to be printed
+ @return 1 if anything is shared
+ */
+static int findShared(PointerMap *shared, SExpr root) {
+    int found = 0;
+    size_t count = 0;
+    size_t capacity = 64;
+    SExpr *stack = malloc(capacity * sizeof(SExpr));
+    stack[count++] = root;
+    while (count > 0) {
+        SExpr expr = stack[--count];
+        const void *address = sharedAddress(expr);
+        if (address == NULL) {
+            continue;
+        }
+        if (pointerMapGet(shared, address, NULL)) {
+            pointerMapPut(shared, address, PRINT_SHARED);
+            found = 1;
+            continue;
+        }
+        pointerMapPut(shared, address, PRINT_SEEN);
+        size_t needed = (expr.type == RECORD) ? expr.record->count : 2;
+        while (count + needed > capacity) {
+            capacity *= 2;
+            stack = realloc(stack, capacity * sizeof(SExpr));
+        }
+        if (expr.type == RECORD) {
+            for (size_t i = 0; i < expr.record->count; i++) {
+                stack[count++] = expr.record->fields[i];
+            }
+        } else if (expr.type == CONS) {
+            stack[count++] = expr.cons->cdr;
+            stack[count++] = expr.cons->car;
+        } else {
+            stack[count++] = expr.lambda->exprs;
+            stack[count++] = expr.lambda->params;
+        }
+    }
+    free(stack);
+    return found;
+}
+
+/**
+ PrintItem Struct, pending work for the iterative printer (private)
+ */
+typedef struct PrintItem PrintItem;
+struct PrintItem {
+    enum { PRINT_EXPR, PRINT_REST, PRINT_TEXT } kind;
+    SExpr expr;         // The SExpr for PRINT_EXPR, the cons whose cdr comes next for PRINT_REST
+    const char *text;   // For PRINT_TEXT
+};
+
+/**
+ Writes the #n= or #n# label of a shared SExpr (private)
+ @param buffer The buffer to write to
+ @param shared The sharing map
+ @param labels The number of labels handed out so far, updated
+ @param address The address of the SExpr
+ @return 1 if the SExpr was already written and only the #n# reference was needed
+ */
+static int writeLabel(Buffer *buffer, PointerMap *shared, size_t *labels, const void *address) {
+    size_t state = PRINT_SEEN;
+    pointerMapGet(shared, address, &state);
+    if (state == PRINT_SEEN) {
+        return 0;
+    }
+    bufferChar(buffer, '#');
+    if (state >= PRINT_LABEL) {
+        bufferInt(buffer, (int64_t) (state - PRINT_LABEL));
+        bufferChar(buffer, '#');
+        return 1;
+    }
+    pointerMapPut(shared, address, PRINT_LABEL + *labels);
+    bufferInt(buffer, (int64_t) *labels);
+    bufferChar(buffer, '=');
+    (*labels)++;
+    return 0;
+}
+
+/**
+ Checks if a cons in the middle of a list needs a label, in which case it is written as a dotted tail (private)
+ @param shared The sharing map
+ @param address The cons
+ @return 1 if it is shared
+ */
+static int needsLabel(PointerMap *shared, const void *address) {
+    size_t state = PRINT_SEEN;
+    pointerMapGet(shared, address, &state);
+    return state != PRINT_SEEN;
+}
+
+/**
+ Writes an SExpr in list form (private)
+ @param buffer The buffer to write to
+ @param expr The SExpr to write
+ @param quoted Write strings in quotes
+ */
+static void writeSExprStyle(Buffer *buffer, SExpr expr, int quoted) {
+    if (sharedAddress(expr) == NULL) {
+        writeAtom(buffer, expr, quoted);
+        return;
+    }
+    PointerMap shared;
+    pointerMapInit(&shared);
+    int labelled = findShared(&shared, expr);
+    size_t labels = 0;
+    
+    size_t count = 0;
+    size_t capacity = 64;
+    PrintItem *stack = malloc(capacity * sizeof(PrintItem));
+    stack[count++] = (PrintItem) { PRINT_EXPR, expr, NULL };
+    while (count > 0) {
+        size_t needed = (stack[count - 1].kind == PRINT_EXPR && stack[count - 1].expr.type == RECORD) ? 2 * stack[count - 1].expr.record->count + 1 : 3;
+        while (count + needed > capacity) {
+            capacity *= 2;
+            stack = realloc(stack, capacity * sizeof(PrintItem));
+        }
+        PrintItem item = stack[--count];
+        if (item.kind == PRINT_TEXT) {
+            bufferString(buffer, item.text);
+        } else if (item.kind == PRINT_REST) { // Between elements of a list
+            SExpr rest = item.expr.cons->cdr;
+            if (rest.type == NIL) {
+                bufferChar(buffer, ')');
+            } else if (rest.type == CONS && !(labelled && needsLabel(&shared, rest.cons))) {
+                bufferChar(buffer, ' ');
+                stack[count++] = (PrintItem) { PRINT_REST, rest, NULL };
+                stack[count++] = (PrintItem) { PRINT_EXPR, rest.cons->car, NULL };
+            } else { // Atom or shared tail
+                bufferAppend(buffer, " . ", 3);
+                stack[count++] = (PrintItem) { PRINT_TEXT, NILObj, ")" };
+                stack[count++] = (PrintItem) { PRINT_EXPR, rest, NULL };
+            }
+        } else if (sharedAddress(item.expr) == NULL) {
+            writeAtom(buffer, item.expr, quoted);
+        } else if (labelled && writeLabel(buffer, &shared, &labels, sharedAddress(item.expr))) {
+            continue; // Already written, only referenced
+        } else if (item.expr.type == CONS) {
+            bufferChar(buffer, '(');
+            stack[count++] = (PrintItem) { PRINT_REST, item.expr, NULL };
+            stack[count++] = (PrintItem) { PRINT_EXPR, item.expr.cons->car, NULL };
+        } else if (item.expr.type == RECORD) { // #<type-name fields...>
+            Record *record = item.expr.record;
+            bufferString(buffer, "#<");
+            bufferString(buffer, record->type->fields[0].symbol);
+            stack[count++] = (PrintItem) { PRINT_TEXT, NILObj, ">" };
+            for (size_t i = record->count; i > 0; i--) {
+                stack[count++] = (PrintItem) { PRINT_EXPR, record->fields[i - 1], NULL };
+                stack[count++] = (PrintItem) { PRINT_TEXT, NILObj, " " };
+            }
+        } else {
+            bufferString(buffer, (item.expr.type == MACRO) ? "MACRO: Params: " : "LAMBDA: Params: ");
+            stack[count++] = (PrintItem) { PRINT_EXPR, item.expr.lambda->exprs, NULL };
+            stack[count++] = (PrintItem) { PRINT_TEXT, NILObj, "\tExprs: " };
+            stack[count++] = (PrintItem) { PRINT_EXPR, item.expr.lambda->params, NULL };
+        }
+    }
+    free(stack);
+    pointerMapFree(&shared);
+}
+
+void writeSExpr(Buffer *buffer, SExpr expr) {
+    writeSExprStyle(buffer, expr, 0);
+}
+
+void writeSExprQuoted(Buffer *buffer, SExpr expr) {
+    writeSExprStyle(buffer, expr, 1);
+}
+
+void printSExpr(SExpr expr) {
+    static _Thread_local Buffer output = { NULL, 0, 0, NULL, -1 }; // Reused so printing does not allocate
+    output.file = stdout;
+    writeSExpr(&output, expr);
+    bufferFlush(&output);
+}
+
+void printSExprToFd(SExpr expr, int fd) {
+    Buffer output;
+    bufferInit(&output);
+    output.fd = fd;
+    TRY_FINALLY({
+        writeSExpr(&output, expr);
+        bufferFlush(&output);
+        }, {
+            bufferFree(&output);
+        });
+}
+
+SExpr sexprToString(SExpr expr) {
+    Buffer output;
+    bufferInit(&output);
+    writeSExpr(&output, expr);
+    SExpr string = stringToSExprLength(output.data, output.length);
+    bufferFree(&output);
+    return string;
+}
+
 const char *SExprName(SExprType type) {
     switch (type) {
         case NIL:
@@ -377,6 +807,10 @@ const char *SExprName(SExprType type) {
             return "LAMBDA";
             break;
             
+        case BUILTIN:
+            return "BUILTIN";
+            break;
+            
         case SYMBOL:
             return "SYMBOL";
             break;
@@ -397,169 +831,47 @@ const char *SExprName(SExprType type) {
             return "CHAR";
             break;
             
-        default:
-            return "INVALID";
-            break;
-    }
-}
-
-SExpr readSExpr(FILE *fp) {
-    Token token = readToken(fp);
-    SExpr expr;
-    switch (token.type) {
-        case TOKEN_END:
-            expr.type = END;
-            break;
-            
-        case TOKEN_SYMBOL:
-            expr = symbolToSExpr(token.value.s);
+        case FUTURE:
+            return "FUTURE";
             break;
             
-        case TOKEN_INT:
-            expr = intToSExpr(token.value.i);
+        case PORT:
+            return "PORT";
             break;
             
-        case TOKEN_REAL:
-            expr = realToSExpr(token.value.r);
-            break;
-        
-        case TOKEN_STRING:
-            expr = stringToSExpr(token.value.str);
+        case MACRO:
+            return "MACRO";
             break;
             
-        case TOKEN_CHAR:
-            expr = charToSExpr(token.value.c);
+        case RECORD:
+            return "RECORD";
             break;
             
-        case TOKEN_OPENP:
-            expr = readList(fp, TOKEN_CLOSEP, TOKEN_CLOSEB);
+        case F64VECTOR:
+            return "F64VECTOR";
             break;
             
-        case TOKEN_OPENB:
-            expr = readList(fp, TOKEN_CLOSEB, TOKEN_CLOSEP);
+        case S64VECTOR:
+            return "S64VECTOR";
             break;
             
-        case TOKEN_QUOTE: {
-            SExpr quote;
-            quote.type = SYMBOL;
-            quote.symbol = sym_QUOTE;
-            expr = consToSExpr(quote, consToSExpr(readSExpr(fp), NILObj));
-            
+        case BYTEVECTOR:
+            return "BYTEVECTOR";
             break;
-            }
-        
-        case TOKEN_BQUOTE: {
-            SExpr quote;
-            quote.type = SYMBOL;
-            quote.symbol = sym_BQUOTE;
-            expr = consToSExpr(quote, consToSExpr(readSExpr(fp), NILObj));
-            
-            break;
-            }
-        
-        case TOKEN_COMMA: {
-            SExpr comma;
-            comma.type = SYMBOL;
-            comma.symbol = sym_COMMA;
-            expr = consToSExpr(comma, consToSExpr(readSExpr(fp), NILObj));
-            
-            break;
-            }
             
         default:
-            fail("Default Error, Not of Valid Token Type");
-    }
-    return expr;
-}
-
-SExpr readList(FILE *fp, TokenType expType, TokenType failType){
-    SExpr expr;
-    Token token = readToken(fp); // First term or close parens
-    if(token.type == expType) { // Auto Nil;
-        expr.type = NIL;
-    } else if (token.type == failType) { // Auto Fail;
-        fail("Incorrect closing character");
-    } else {
-        unreadToken(token);
-        SExpr car = readSExpr(fp);
-        if (car.type == EOF) {
-            fail("Early EOF");
-        }
-        expr = consToSExpr(car, NILObj); // First
-        expr.type = CONS;
-        SExpr last = expr;
-        
-        token = readToken(fp);
-        while(token.type != expType) {
-            if (token.type == failType) { // Auto Fail;
-                fail("Incorrect closing character");
-            }
-            if (token.type == TOKEN_DOT) {
-                SExpr cdr = readSExpr(fp);
-                if (cdr.type == EOF) {
-                    fail("Early EOF");
-                }
-                last.cons->cdr = cdr;
-                token = readToken(fp);
-                if (token.type != expType) {
-                    if (token.type == failType) { // Auto Fail;
-                        fail("Incorrect closing character");
-                    }
-                    fail("Invalid Token of type: %s instead of CLOSE P", tokenName(token.type));
-                }
-                unreadToken(token);
-                
-            } else {
-                unreadToken(token);
-                car = readSExpr(fp);
-                if (car.type == END) {
-                    fail("Early EOF");
-                }
-                last.cons->cdr = consToSExpr(car, NILObj);
-                last = last.cons->cdr;
-            }
-            token = readToken(fp);
-        }
-        
+            return "INVALID";
+            break;
     }
-    return expr;
-}
-
-SExpr car(SExpr c) {
-    check(c.type == CONS);
-    return c.cons->car;
-}
-
-SExpr cdr(SExpr c) {
-    check(c.type == CONS);
-    return c.cons->cdr;
-}
-
-SExpr cadr(SExpr c) {
-    return car(cdr(c));
-}
-
-SExpr caar(SExpr c) {
-    return car(car(c));
-}
-
-SExpr cdar(SExpr c) {
-    return cdr(car(c));
 }
 
-SExpr cddr(SExpr c) {
-    return cdr(cdr(c));
-}
-
-
 SExpr length(SExpr list) {
-    check(isLIST(list));
     SExpr len;
     len.type = INT;
-    if (isNIL(list)) {
-        len.i = 0;
-    } else {
-        len.i = length(cdr(list)).i + 1;
+    len.i = 0;
+    for (; !isNIL(list); list = uncheckedCdr(list)) {
+        check(isCONS(list));
+        len.i++;
     }
     return len;
 }
@@ -576,10 +888,47 @@ SExpr setcdr(SExpr target, SExpr value) {
 
 SExpr assoc(SExpr key, SExpr a_list) {
     // find the first key-value pair in a_list with a key that matches key
-    for(SExpr list = a_list; !isNIL(list); list = cdr(list)) {
-        check(car(list).type == CONS);
-        SExpr SOI = car(list); // SExpr of Interest
-        if (!isNIL(eq(car(SOI), key))) {
+    for(SExpr list = a_list; !isNIL(list); list = uncheckedCdr(list)) {
+        check(isCONS(list));
+        SExpr SOI = uncheckedCar(list); // SExpr of Interest
+        check(isCONS(SOI));
+        if (!isNIL(eq(uncheckedCar(SOI), key))) {
+            return SOI;
+        }
+    }
+    return NILObj;
+}
+
+SExpr assq(SExpr key, SExpr a_list) {
+    if (key.type == SYMBOL) { // Environment lookups, one pointer compare per entry
+        for (SExpr list = a_list; !isNIL(list); list = uncheckedCdr(list)) {
+            check(isCONS(list));
+            SExpr SOI = uncheckedCar(list);
+            check(isCONS(SOI));
+            SExpr SOIKey = uncheckedCar(SOI);
+            if (SOIKey.symbol == key.symbol && SOIKey.type == SYMBOL) {
+                return SOI;
+            }
+        }
+        return NILObj;
+    }
+    for (SExpr list = a_list; !isNIL(list); list = uncheckedCdr(list)) {
+        check(isCONS(list));
+        SExpr SOI = uncheckedCar(list);
+        check(isCONS(SOI));
+        if (identical(uncheckedCar(SOI), key)) {
+            return SOI;
+        }
+    }
+    return NILObj;
+}
+
+SExpr assv(SExpr key, SExpr a_list) {
+    for (SExpr list = a_list; !isNIL(list); list = uncheckedCdr(list)) {
+        check(isCONS(list));
+        SExpr SOI = uncheckedCar(list);
+        check(isCONS(SOI));
+        if (!isNIL(eqvp(uncheckedCar(SOI), key))) {
             return SOI;
         }
     }
@@ -591,141 +940,127 @@ SExpr acons(SExpr key, SExpr value, SExpr a_list) {
     return consToSExpr(consToSExpr(key, value), a_list);
 }
 
-SExpr addSExpr(SExpr args) {
-    SExpr result;
-    if (args.type == NIL) {
-        result.type = INT;
-        result.i = 0;
-    } else {
-        SExpr first = car(args);
-        if (first.type != INT && first.type != REAL) {
-            fail("Addition of type: %s", SExprName(first.type));
+SExpr arrayToList(size_t count, const SExpr *items) {
+    SExpr list = NILObj;
+    for (size_t i = count; i > 0; i--) {
+        list = consToSExpr(items[i - 1], list);
+    }
+    return list;
+}
+
+/**
+    Checks that every argument is a number (private)
+ @param argc The number of arguments
+ @param argv The arguments
+ @param operation The name of the operation for the failure message
+ */
+static void checkNumbers(int argc, const SExpr *argv, const char *operation) {
+    for (int i = 0; i < argc; i++) {
+        if (argv[i].type != INT && argv[i].type != REAL) {
+            fail("%s of type: %s", operation, SExprName(argv[i].type));
         }
-        SExpr rest = addSExpr(cdr(args));
-        if (rest.type == REAL) {
+    }
+}
+
+/**
+    Adds numbers from the right, so reals round the same as the recursive list version did (private)
+ @param argc The number of arguments
+ @param argv The arguments, already checked
+ @return The sum, REAL if any argument is
+ */
+static SExpr sumRight(int argc, const SExpr *argv) {
+    SExpr result = intToSExpr(0);
+    for (int i = argc - 1; i >= 0; i--) {
+        SExpr first = argv[i];
+        if (result.type == REAL) {
+            result.r = ((first.type == REAL) ? first.r : (double) first.i) + result.r;
+        } else if (first.type == REAL) {
             result.type = REAL;
-            if (first.type == REAL) {
-                result.r = first.r + rest.r;
-            } else {
-                result.r = (double) first.i + rest.r;
-            }
+            result.r = first.r + (double) result.i;
         } else {
-            if (first.type == REAL) {
-                result.type = REAL;
-                result.r = first.r + (double) rest.i;
-            } else {
-                result.type = INT;
-                result.i =  first.i + rest.i;
-            }
+            result.i = first.i + result.i;
         }
     }
     return result;
 }
 
-SExpr subtractSExpr(SExpr args) {
-    SExpr result;
-    if (args.type == NIL) {
-        result.type = INT;
-        result.i = 0;
-    } else {
-        SExpr first = car(args);
-        
-        if (first.type != INT && first.type != REAL) { // Type checking
-            fail("Subtraction of type: %s", SExprName(first.type));
-        }
-        
-        if (cdr(args).type == NIL) {
-            if (first.type == REAL) {
-                result.type = REAL;
-                result.r = -first.r;
-            } else {
-                result.type = INT;
-                result.i = -first.i;
-            }
-            return result;
-        }
-        
-        SExpr rest = addSExpr(cdr(args));
-        
-        if (rest.type == REAL) {
+/**
+    Multiplies numbers from the right (private)
+ @param argc The number of arguments
+ @param argv The arguments, already checked
+ @return The product, REAL if any argument is
+ */
+static SExpr productRight(int argc, const SExpr *argv) {
+    SExpr result = intToSExpr(1);
+    for (int i = argc - 1; i >= 0; i--) {
+        SExpr first = argv[i];
+        if (result.type == REAL) {
+            result.r = ((first.type == REAL) ? first.r : (double) first.i) * result.r;
+        } else if (first.type == REAL) {
             result.type = REAL;
-            if (first.type == REAL) {
-                result.r = first.r - rest.r;
-            } else {
-                result.r = (double) first.i - rest.r;
-            }
+            result.r = first.r * (double) result.i;
         } else {
-            if (first.type == REAL) {
-                result.type = REAL;
-                result.r = first.r - (double) rest.i;
-            } else {
-                result.type = INT;
-                result.i =  first.i - rest.i;
-            }
+            result.i = first.i * result.i;
         }
     }
     return result;
 }
 
-SExpr multiplySExpr(SExpr args) {
+SExpr addSExpr(int argc, SExpr *argv) {
+    checkNumbers(argc, argv, "Addition");
+    return sumRight(argc, argv);
+}
+
+SExpr subtractSExpr(int argc, SExpr *argv) {
+    if (argc == 0) {
+        return intToSExpr(0);
+    }
+    SExpr first = argv[0];
+    checkNumbers(1, argv, "Subtraction");
     SExpr result;
-    if (args.type == NIL) {
-        result.type = INT;
-        result.i = 1; // Terminating Condition
-    } else {
-        SExpr first = car(args);
-        if (first.type != INT && first.type != REAL) {
-            fail("Multiplication of type: %s", SExprName(first.type));
-        }
-        SExpr rest = multiplySExpr(cdr(args));
-        if (rest.type == REAL) {
+    if (argc == 1) {
+        if (first.type == REAL) {
             result.type = REAL;
-            if (first.type == REAL) {
-                result.r = first.r * rest.r;
-            } else {
-                result.r = (double) first.i * rest.r;
-            }
+            result.r = -first.r;
         } else {
-            if (first.type == REAL) {
-                result.type = REAL;
-                result.r = first.r * (double) rest.i;
-            } else {
-                result.type = INT;
-                result.i =  first.i * rest.i;
-            }
+            result.type = INT;
+            result.i = -first.i;
         }
+        return result;
+    }
+    checkNumbers(argc - 1, argv + 1, "Addition");
+    SExpr rest = sumRight(argc - 1, argv + 1);
+    if (rest.type == REAL) {
+        result.type = REAL;
+        result.r = ((first.type == REAL) ? first.r : (double) first.i) - rest.r;
+    } else if (first.type == REAL) {
+        result.type = REAL;
+        result.r = first.r - (double) rest.i;
+    } else {
+        result.type = INT;
+        result.i = first.i - rest.i;
     }
     return result;
 }
 
-SExpr divideSExpr(SExpr args) {
+SExpr multiplySExpr(int argc, SExpr *argv) {
+    checkNumbers(argc, argv, "Multiplication");
+    return productRight(argc, argv);
+}
+
+SExpr divideSExpr(int argc, SExpr *argv) {
     SExpr result;
-    if (args.type == NIL) {
-        result.type = REAL;
+    result.type = REAL;
+    if (argc == 0) {
         result.r = 1.0;
-    } else {
-        SExpr first = car(args);
-        if (first.type != INT && first.type != REAL) {
-            fail("Division of type: %s", SExprName(first.type));
-        }
-        SExpr rest = multiplySExpr(cdr(args));
-        
-        result.type = REAL;
-        
-        if (rest.type == REAL) {
-            if (first.type == REAL) {
-                result.r = first.r / rest.r;
-            } else {
-                result.r = (double) first.i / rest.r;
-            }
-        } else {
-            if (first.type == REAL) {
-                result.r = first.r / (double) rest.i;
-            } else {
-                result.r = (double) first.i / (double) rest.i;
-            }
-        }
+        return result;
     }
+    SExpr first = argv[0];
+    checkNumbers(1, argv, "Division");
+    checkNumbers(argc - 1, argv + 1, "Multiplication");
+    SExpr rest = productRight(argc - 1, argv + 1);
+    double numerator = (first.type == REAL) ? first.r : (double) first.i;
+    result.r = numerator / ((rest.type == REAL) ? rest.r : (double) rest.i);
     return result;
 }
 
@@ -825,7 +1160,7 @@ SExpr strlength(SExpr arg) {
     if (arg.type != STRING) {
         return stringToSExpr("Not of String Type");
     } else {
-        return intToSExpr(strlen(arg.string));
+        return intToSExpr((int64_t) stringLength(arg));
     }
 }
 
@@ -841,11 +1176,14 @@ SExpr strup(SExpr arg) {
     if (arg.type != STRING) {
         return stringToSExpr("Not of Type STRING");
     } else {
-        char buf[BUFSIZ] = {0};
-        for (int i = 0; i < strlen(arg.string); i++) {
-            buf[i] = toupper(arg.string[i]);
+        size_t length = stringLength(arg);
+        char *upper = allocString(length);
+        for (size_t i = 0; i < length; i++) {
+            upper[i] = toupper((unsigned char) arg.string[i]);
         }
-        return stringToSExpr(buf);
+        SExpr string = { STRING };
+        string.string = upper;
+        return string;
     }
 }
 
@@ -853,68 +1191,71 @@ SExpr strlow(SExpr arg) {
     if (arg.type != STRING) {
         return stringToSExpr("Not of Type STRING");
     } else {
-        char buf[BUFSIZ] = {0};
-        for (int i = 0; i < strlen(arg.string); i++) {
-            buf[i] = tolower(arg.string[i]);
+        size_t length = stringLength(arg);
+        char *lower = allocString(length);
+        for (size_t i = 0; i < length; i++) {
+            lower[i] = tolower((unsigned char) arg.string[i]);
         }
-        return stringToSExpr(buf);
+        SExpr string = { STRING };
+        string.string = lower;
+        return string;
     }
 }
 
 SExpr evalAppend(SExpr args) {
-    if (!isNIL(cdr(args))) {
-        SExpr rest = evalAppend(cdr(args));
-        return append(car(args), rest);
-    } else {
+    if (isNIL(cdr(args))) {
         return car(args);
     }
+    size_t length = 0;
+    for (SExpr current = args; isCONS(current); current = uncheckedCdr(current)) {
+        if (uncheckedCar(current).type != STRING) {
+            return stringToSExpr("Not of Type STRING");
+        }
+        length += stringLength(uncheckedCar(current));
+    }
+    char *joined = allocString(length); // Sized once from the stored lengths, each piece copied once
+    size_t offset = 0;
+    for (SExpr current = args; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr piece = uncheckedCar(current);
+        memcpy(joined + offset, piece.string, stringLength(piece));
+        offset += stringLength(piece);
+    }
+    SExpr string = { STRING };
+    string.string = joined;
+    return string;
 }
 
 SExpr append(SExpr a, SExpr b) {
-    if ((a.type != STRING) || (b.type != STRING)) {
-        return stringToSExpr("Not of Type STRING");
-    } else {
-        int alen = (int) strlen(a.string);
-        int blen = (int) strlen(b.string);
-        if ((alen + blen) >= BUFSIZ) {
-            fail("Strings are too long and exceed BUFSIZ");
-        }
-        
-        char buf[BUFSIZ] = {0};
-        for (unsigned int  i = 0; i < alen; i++) {
-            buf[i] = a.string[i];
-        }
-        for (int i = alen; i < (alen + blen); i++) {
-            buf[i] = b.string[i - alen];
-        }
-        return stringToSExpr(buf);
-    }
+    return evalAppend(consToSExpr(a, consToSExpr(b, NILObj)));
 }
 
-SExpr substring(SExpr string, int start, int end) {
+/**
+    Copies part of a string (private)
+ @param string The string
+ @param start The index of the first byte
+ @param end The index after the last byte
+ @return The new string
+ */
+static SExpr substring(SExpr string, size_t start, size_t end) {
     check(string.type == STRING);
-    char buf[BUFSIZ] = {0};
-    for (int i = start; i < end; i++) {
-        buf[i - start] = string.string[i];
-    }
-    SExpr substring = stringToSExpr(strdup(buf));
-    return substring;
+    check(start <= end && end <= stringLength(string));
+    return stringToSExprLength(string.string + start, end - start);
 }
 
 SExpr evalSubstring(SExpr args){
     SExpr str = car(args);
     SExpr start = cadr(args);
     check(str.type == STRING);
-    check(start.type == INT);
+    check(start.type == INT && start.i >= 0);
     SExpr end;
     if (isNIL(cddr(args))) {
-        end.type = INT;
-        end.i = strlen(str.string);
+        end = intToSExpr((int64_t) stringLength(str));
     } else {
         end = car(cddr(args));
+        check(end.type == INT && end.i >= 0);
     }
     
-    return substring(str, (int) start.i, (int) end.i);
+    return substring(str, (size_t) start.i, (size_t) end.i);
 }
 
 SExpr Char(SExpr arg) {
@@ -960,28 +1301,32 @@ SExpr charlow(SExpr arg) {
 }
 
 SExpr evalListToString(SExpr args) {
-    if (!isNIL(cdr(args))) {
-        SExpr rest = evalListToString(cdr(args));
-        char buf[2] = {0};
-        buf[0] = car(args).c;
-        return append(stringToSExpr(strdup(buf)), rest);
-    } else {
-        char buf[2] = {0};
-        buf[0] = car(args).c;
-        return stringToSExpr(strdup(buf));
+    if (isLIST(car(args)) && isNIL(cdr(args))) { // (list->string list) as well as (list->string chars...)
+        args = car(args);
+    }
+    size_t length = 0;
+    for (SExpr current = args; isCONS(current); current = uncheckedCdr(current)) {
+        check(uncheckedCar(current).type == CHAR);
+        length++;
     }
+    char *chars = allocString(length);
+    size_t i = 0;
+    for (SExpr current = args; isCONS(current); current = uncheckedCdr(current)) {
+        chars[i++] = uncheckedCar(current).c;
+    }
+    SExpr string = { STRING };
+    string.string = chars;
+    return string;
 }
 
 SExpr stringToList(SExpr arg){
     if (arg.type != STRING) {
         return stringToSExpr("Not of Type STRING");
     } else {
-        SExpr car = charToSExpr(arg.string[0]);
-        if (strlen(arg.string) == 1) {
-            return consToSExpr(car, NILObj);
-        } else {
-            SExpr rest = substring(arg, 1, (int) strlen(arg.string));
-            return consToSExpr(car, stringToList(rest));
+        SExpr list = NILObj;
+        for (size_t i = stringLength(arg); i > 0; i--) { // Built from the back, one cons per char
+            list = consToSExpr(charToSExpr(arg.string[i - 1]), list);
         }
+        return list;
     }
 }
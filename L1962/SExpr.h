@@ -11,6 +11,7 @@
 #include <stdint.h>
 
 #include "Tokenizer.h"
+#include "buffer.h"
 
 extern const char *sym_QUOTE; // Quote symbol value
 extern const char *sym_BQUOTE; // Backquote symbol value
@@ -27,10 +28,19 @@ extern const char *sym_UNLESS; // unless symbol value
 extern const char *sym_AND; // and symbol value
 extern const char *sym_OR; // or symbol value
 extern const char *sym_LET; // let symbol value
+extern const char *sym_LETStar; // let* symbol value
 extern const char *sym_PROGN; // progn symbol value
 extern const char *sym_BEGIN; // begin symbol value
 extern const char *sym_APPLY; // apply symbol value
 extern const char *sym_MACRO; // macro symbol value
+extern const char *sym_DEFMACRO; // defmacro symbol value
+extern const char *sym_FUTURE; // future symbol value
+extern const char *sym_WHILE; // while symbol value
+extern const char *sym_DO; // do symbol value
+extern const char *sym_DOTIMES; // dotimes symbol value
+extern const char *sym_DOLIST; // dolist symbol value
+extern const char *sym_DEFSTRUCT; // defstruct symbol value
+extern const char *sym_DEFINE_RECORD_TYPE; // define-record-type symbol value
 
 typedef enum { // SExpression Types
     NIL,    // Nothing
@@ -44,6 +54,13 @@ typedef enum { // SExpression Types
     STRING,
     END,
     CHAR,
+    FUTURE,
+    PORT,
+    MACRO,  // Shares the lambda member, the lambda is the expander
+    RECORD,
+    F64VECTOR,  // Shares the vector member
+    S64VECTOR,
+    BYTEVECTOR, // Laid out like a STRING, in the bytes member
 } SExprType;
 
 typedef struct SExpr SExpr;
@@ -54,10 +71,18 @@ typedef struct Lambda Lambda;
 
 typedef struct Builtin Builtin;
 
-typedef struct Macro Macro;
+typedef struct Future Future;
+
+typedef struct Port Port;
+
+typedef struct Record Record;
+
+typedef struct Vector Vector;
+
+typedef struct Node Node;
 
 struct Builtin {
-  SExpr (*apply)(SExpr args);
+  SExpr (*apply)(int argc, SExpr *argv); // Arguments in a contiguous array, usually on the caller's stack
 };
 
 struct SExpr { // SExpression Struct
@@ -69,8 +94,13 @@ struct SExpr { // SExpression Struct
         int64_t i;
         double r;
         const char *symbol;
-        const char *string;
+        const char *string; // Preceded by its length, see stringLength
+        uint8_t *bytes;
         char c;
+        Future *future;
+        Port *port;
+        Record *record;
+        Vector *vector;
     };
 };
 
@@ -83,10 +113,21 @@ struct Lambda{ // Lisp style list notation
     SExpr params;
     SExpr exprs;
     SExpr env; // Support for Lexical scope
+    Node *code; // Analyzed body, NULL until the lambda is first called if it wasn't made by a lambda node
 };
 
-struct Macro {
-  SExpr *lambda;
+struct Record{ // Instance of a defstruct or define-record-type, fields are at fixed offsets
+    Record *type; // The type descriptor, itself a record: fields[0] is the type name and fields[1] the field names
+    size_t count;
+    SExpr fields[];
+};
+
+struct Vector{ // Unboxed numbers stored contiguously, f64vector or s64vector
+    size_t length;
+    union {
+        double *f64;
+        int64_t *s64;
+    };
 };
 
 
@@ -121,6 +162,15 @@ inline int isLIST(SExpr c) {
     return isNIL(c) || isCONS(c);
 }
 
+/**
+    The length of a STRING or BYTEVECTOR, kept in the word just before its first byte so it is O(1) and may count NULs
+ @param c The STRING or BYTEVECTOR
+ @return The number of bytes, not counting the NUL that always follows them
+ */
+inline size_t stringLength(SExpr c) {
+    return ((const size_t *) (const void *) c.string)[-1];
+}
+
 /**
     SExpr Initializatiosn (for comparisons)
  */
@@ -134,11 +184,29 @@ void SExprInit(void);
 int isTrue(SExpr c);
 
 /**
-    Are the two SExprs equal (equivalent lisp expression: equal)
+    Are the two SExprs equal (equivalent lisp expression: equal?), lists are compared element by element without recursion on the C stack
  @return NILObj or TObj given the equality
  */
 SExpr eq(SExpr a, SExpr b);
 
+/**
+    Are the two SExprs the same object, immediates (numbers, chars, symbols) compare by value and everything else by pointer
+ @return 1 if identical, 0 if not
+ */
+int identical(SExpr a, SExpr b);
+
+/**
+    eq? builtin
+ @return NILObj or TObj given identical
+ */
+SExpr eqp(SExpr a, SExpr b);
+
+/**
+    eqv? builtin, eq? except that reals compare numerically
+ @return NILObj or TObj given the equivalence
+ */
+SExpr eqvp(SExpr a, SExpr b);
+
 
 /**
     Makes a Cons cell
@@ -180,7 +248,7 @@ SExpr lambdaToSExpr(SExpr params, SExpr exprs, SExpr env);
  @return The builtin as an SExpr
  */
 
-SExpr makeBuiltin(SExpr (*apply)(SExpr args));
+SExpr makeBuiltin(SExpr (*apply)(int argc, SExpr *argv));
 
 /**
     Makes an int an SExpr
@@ -223,6 +291,29 @@ SExpr makeNIL(void);
  */
 SExpr stringToSExpr(const char* str);
 
+/**
+    Allocates the storage of a STRING or BYTEVECTOR, with its length set and a NUL after the last byte
+ @param length The number of bytes
+ @return The first byte, to be filled in, or NULL if out of memory
+ */
+char *allocString(size_t length);
+
+/**
+    Makes a string from bytes that may include NULs
+ @param bytes The bytes to copy
+ @param length The number of bytes
+ @return The new SExpr
+ */
+SExpr stringToSExprLength(const char *bytes, size_t length);
+
+/**
+    Makes a bytevector from bytes
+ @param bytes The bytes to copy, NULL to leave them zeroed
+ @param length The number of bytes
+ @return The new SExpr
+ */
+SExpr bytevectorToSExpr(const uint8_t *bytes, size_t length);
+
 /**
     Makes a char an SExpr
  @param c The char to convert to an SExpr
@@ -237,11 +328,39 @@ SExpr charToSExpr(char c);
 void debugSExpr(SExpr expr);
 
 /**
-    Prints an SExpr in list form
+    Writes an SExpr in list form into a buffer (the same text printSExpr prints)
+ @param buffer The buffer to write to, flushed in chunks if it has a sink
+ @param expr The SExpr to write
+ */
+void writeSExpr(Buffer *buffer, SExpr expr);
+
+/**
+    Writes an SExpr so it reads back, like writeSExpr but with strings in quotes
+ @param buffer The buffer to write to, flushed in chunks if it has a sink
+ @param expr The SExpr to write
+ */
+void writeSExprQuoted(Buffer *buffer, SExpr expr);
+
+/**
+    Prints an SExpr in list form to stdout with a single write
  @param expr The SExpr to print
  */
 void printSExpr(SExpr expr);
 
+/**
+    Prints an SExpr in list form to a file descriptor, bypassing stdio
+ @param expr The SExpr to print
+ @param fd The file descriptor to write to
+ */
+void printSExprToFd(SExpr expr, int fd);
+
+/**
+    sexpr->string Builtin - the printed form of an SExpr as a string, without going through stdout
+ @param expr The SExpr to convert
+ @return The STRING SExpr
+ */
+SExpr sexprToString(SExpr expr);
+
 /**
     Returns the name of a SExprType as a string from the enum
  @param type  The SExprType to process
@@ -250,65 +369,81 @@ void printSExpr(SExpr expr);
 const char *SExprName(SExprType type);
 
 /**
-    Reads an SExpr and only one SExpr
- @param fp   The file pointer for the file to be read and parsed
- @return The next SExpr in the file as a SExpr struct
+    car without the type check, only for use where the caller has already verified the CONS
+ @param c The cons to get the car of
+ @return The car of the cons
  */
-SExpr readSExpr(FILE *fp);
+inline SExpr uncheckedCar(SExpr c) {
+    return c.cons->car;
+}
 
 /**
-    Deals with bracketing chars
- @param fp   The file pointer for the file to be read and parsed
- @param expType The expected closing type
- @param failType The failing closing type
- @return The next SExpr in the file as a SExpr struct
+    cdr without the type check, only for use where the caller has already verified the CONS
+ @param c The cons to get the cdr of
+ @return The cdr of the cons
  */
-SExpr readList(FILE *fp, TokenType expType, TokenType failType);
+inline SExpr uncheckedCdr(SExpr c) {
+    return c.cons->cdr;
+}
 
 /**
     car Builtin - gets the first element of the cons
  @param c The cons to get the car of
  @return The car of the cons
  */
-SExpr car(SExpr c);
+inline SExpr car(SExpr c) {
+    check(isCONS(c));
+    return c.cons->car;
+}
 
 /**
     cdr Builtin - gets the rest of the cons
  @param c The cons to get the cdr of
  @return The cdr of the cons
  */
-SExpr cdr(SExpr c);
+inline SExpr cdr(SExpr c) {
+    check(isCONS(c));
+    return c.cons->cdr;
+}
 
 /**
     cadr Builtin - gets the first element of the rest of the cons
  @param c The cons to get the cadr of
  @return The cadr of the cons
  */
-SExpr cadr(SExpr c);
+inline SExpr cadr(SExpr c) {
+    return car(cdr(c));
+}
 
 /**
     caar Builtin - gets the first element of the first element of the cons
  @param c The cons to get the caar of
  @return The caar of the cons
  */
-SExpr caar(SExpr c);
+inline SExpr caar(SExpr c) {
+    return car(car(c));
+}
 
 /**
     cdar Builtin - gets the rest of the first of the cons
  @param c The cons to get the cdar of
  @return The cdar of the cons
  */
-SExpr cdar(SExpr c);
+inline SExpr cdar(SExpr c) {
+    return cdr(car(c));
+}
 
 /**
     cddr Builtin - gets the rest of the rest of the cons
  @param c The cons to get the cddr of
  @return The cddr of the cons
  */
-SExpr cddr(SExpr c);
+inline SExpr cddr(SExpr c) {
+    return cdr(cdr(c));
+}
 
 /**
-    length Builtin - gets the length of the list (recursive call)
+    length Builtin - gets the length of the list
  @param list The list to find the length of
  @return The length as an SExpr
  */
@@ -338,6 +473,22 @@ SExpr setcdr(SExpr target, SExpr value);
  */
 SExpr assoc(SExpr key, SExpr a_list);
 
+/**
+    assq builtin, assoc comparing keys with eq?, environment lookups go through here
+ @param key The key to find in the a-list
+ @param a_list The a-list to look in
+ @return The first matching pair
+ */
+SExpr assq(SExpr key, SExpr a_list);
+
+/**
+    assv builtin, assoc comparing keys with eqv?
+ @param key The key to find in the a-list
+ @param a_list The a-list to look in
+ @return The first matching pair
+ */
+SExpr assv(SExpr key, SExpr a_list);
+
 /**
     acons builtin (add to front of an a-list)
  @param key The key to add for the pair
@@ -347,33 +498,45 @@ SExpr assoc(SExpr key, SExpr a_list);
  */
 SExpr acons(SExpr key, SExpr value, SExpr a_list);
 
+/**
+    Makes a list of the SExprs in an array
+ @param count The number of SExprs
+ @param items The SExprs
+ @return The list
+ */
+SExpr arrayToList(size_t count, const SExpr *items);
+
 /**
     + builtin (add rest to first)
- @param args The SExpr to build the addition sequence from
+ @param argc The number of terms
+ @param argv The terms to build the addition sequence from
  @return The answer as an SExpr for 0 terms: 0, for 1 term: itself, for 2+ terms: recursive addition (autoconvert to REAL if necessary)
  */
-SExpr addSExpr(SExpr args);
+SExpr addSExpr(int argc, SExpr *argv);
 
 /**
     - builtin (subract rest from first)
- @param args The SExpr to build the subtraction sequence from
+ @param argc The number of terms
+ @param argv The terms to build the subtraction sequence from
  @return The answer as an SExpr for 0 terms: 0, for 1 term: negated itself, for 2+ terms: first minus sum of rest (recursive addition) (autoconvert to REAL if necessary)
  */
-SExpr subtractSExpr(SExpr args);
+SExpr subtractSExpr(int argc, SExpr *argv);
 
 /**
     * builtin (multiply first by rest)
- @param args The SExpr to build the multiplication sequence from
+ @param argc The number of terms
+ @param argv The terms to build the multiplication sequence from
  @return The answer as an SExpr for 0 terms: 1, for 1 term: itself, for 2+ terms: recursive multiplication (autoconvert to REAL if necessary)
  */
-SExpr multiplySExpr(SExpr args);
+SExpr multiplySExpr(int argc, SExpr *argv);
 
 /**
     / builtin (divide first by rest)
- @param args The SExpr to build the division sequence from
+ @param argc The number of terms
+ @param argv The terms to build the division sequence from
  @return The answer as an SExpr for 0 terms: 1, for 1 term: itself, for 2+ terms: first divided by product of rest (recursive multiplication) (autoconvert to REAL if necessary)
  */
-SExpr divideSExpr(SExpr args);
+SExpr divideSExpr(int argc, SExpr *argv);
 
 /**
     > builtin
@@ -507,7 +670,7 @@ SExpr charup(SExpr arg);
 SExpr charlow(SExpr arg);
 /**
     Eval list->string
- @param args Turns a list of char into a string
+ @param args Turns a list of char into a string, either the chars themselves or a single list of them
  @return The appeneded string
  */
 SExpr evalListToString(SExpr args);
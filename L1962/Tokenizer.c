@@ -7,9 +7,6 @@
 //
 #include "Tokenizer.h"
 
-static Token unread;
-static int unreadPresent = 0;
-
 /**
     Checks if a character is part of the allowed character set for the beginning of a symbol token
  @param c   The character to check if it is in the set for a valid symbol token (leading symbol)
@@ -36,196 +33,230 @@ int isSymbolContinue(int c) {
     }
 }
 
-Token readToken(FILE *fp) {
-    
-    if (unreadPresent) { //if unread has been called, reset flag and print the unread value
-        unreadPresent = 0;
-        return unread;
+/**
+    Checks if a character can begin a token, anything else between tokens is skipped (private)
+ @param c The character to check
+ @return True if a token can start with c
+ */
+static int startsToken(unsigned char c) {
+    return isSymbol(c) || isdigit(c) || (c != 0 && strchr("-.()[]'`,\"#", c) != NULL);
+}
+
+/**
+    Finishes a numeric or symbol token from its text (private)
+ @param token The token to fill in, its type already set
+ @param text The start of the token's text
+ @param length The length of the token's text
+ */
+static void finishToken(Token *token, const char *text, size_t length) {
+    char small[64];
+    char *buf = length < sizeof(small) ? small : malloc(length + 1);
+    memcpy(buf, text, length);
+    buf[length] = 0;
+    switch (token->type) {
+        case TOKEN_INT:
+            errno = 0;
+            token->value.i = strtoll(buf, NULL, 10);
+            if (errno == ERANGE) { // Too large for an INT, read as a REAL rather than clamped
+                token->type = TOKEN_REAL;
+                token->value.r = strtod(buf, NULL);
+            }
+            break;
+            
+        case TOKEN_REAL:
+            token->value.r = atof(buf);
+            break;
+            
+        case TOKEN_SYMBOL:
+            token->value.s = struniq(buf);
+            break;
+            
+        default:
+            break;
     }
-    
-    Token token;
-    int c = getc(fp);      // Gets next char in fp
-    if (c == EOF) {         // Early return if EF
-        token.type = TOKEN_END;
-        return token;
+    if (buf != small) {
+        free(buf);
     }
+}
+
+int scanToken(const char *data, size_t length, int eof, Token *token, size_t *used) {
+    size_t i = 0;
+    // Skip whitespace, comments and invalid characters
+    while (1) {
+        if (i == length) {
+            *used = i;
+            if (eof) {
+                token->type = TOKEN_END;
+                return 1;
+            }
+            return 0;
+        }
+        unsigned char c = data[i];
+        if (c == ';') { // Rest of line is a comment, it must be seen through to the '\n' before it can be dropped
+            size_t j = i;
+            while (j < length && data[j] != '\n') {
+                j++;
+            }
+            if (j == length && !eof) {
+                *used = i;
+                return 0;
+            }
+            i = j;
+        } else if (!startsToken(c)) {
+            i++;
+        } else {
+            break;
+        }
+    }
+    *used = i; // Only the skipped prefix is consumed until the token is known to be complete
     
-    int index = 0;
-    char buf[BUFSIZ] = {0};       // Compiler allocates in a smart way, reallocates it at same location
-    
-    TokenType id;      // Matching ID for the given char
-    
-    if(c == '-') { // Special Minus sign case
-        buf[index++] = c;
-        buf[index] = 0;
-        id = TOKEN_SYMBOL;
-        c = getc(fp);
-        if (isspace(c) || c == ')' || c == '(') { // solo minus sign check
-            token.type = TOKEN_SYMBOL;
-            token.value.s = struniq(buf);
-            ungetc(c, fp);
-            return token;
+    size_t start = i;
+    size_t end = length;
+    unsigned char c = data[start];
+    if (c == '-') { // Special minus sign case
+        if (start + 1 == length && !eof) {
+            return 0;
+        }
+        unsigned char next = start + 1 < length ? data[start + 1] : ' ';
+        if (isSymbol(next)) {
+            c = next;
+            i = start + 1;
+        } else if (isdigit(next) || (next == '.' && start + 2 < length && isdigit((unsigned char) data[start + 2]))) {
+            c = next;
+            i = start + 1;
+        } else if (next == '.' && start + 2 == length && !eof) {
+            return 0;
+        } else { // Solo minus sign
+            token->type = TOKEN_SYMBOL;
+            token->value.s = struniq("-");
+            *used = start + 1;
+            return 1;
         }
     }
     
     if (isSymbol(c)) {
-        id = TOKEN_SYMBOL;
-        buf[index++] = c;
-        for (c = getc(fp); isSymbolContinue(c); c = getc(fp)) { // While is a matching symbol add to buffer and increment index
-            buf[index++] = c;
-        }
-        ungetc(c, fp);      // Roll position in fp back to allow proper reading
-        buf[index] = 0;     // End Token Value
+        token->type = TOKEN_SYMBOL;
+        for (end = i + 1; end < length && isSymbolContinue((unsigned char) data[end]); end++);
     } else if (c == '.') {
-        buf[index++] = c;
-        c = getc(fp); // For get next
-        if (!((c >= '0') && (c <= '9'))) {
-            id = TOKEN_DOT;
-            ungetc(c, fp);
-            index++;
-            token.type = TOKEN_DOT;
-            return token;
-        } else {
-            id = TOKEN_REAL;
-            while ((c >= '0') && (c <= '9')) { // Real
-                buf[index++] = c;
-                c = getc(fp);
-            }
-            ungetc(c, fp);      // Roll position in fp back to allow proper reading
-            buf[index] = 0;     // End Token Value
+        if (i + 1 == length && !eof) {
+            return 0;
+        }
+        if (i + 1 == length || !isdigit((unsigned char) data[i + 1])) {
+            token->type = TOKEN_DOT;
+            *used = i + 1;
+            return 1;
         }
-    } else if (((c >= '0') && (c <= '9'))) {
-        id = TOKEN_INT;
-        buf[index++] = c;
-        int decimal = 1;    // Decimal signifier
-        for (c = getc(fp); (((c >= '0') && (c <= '9')) || ((c == '.') && decimal)); c = getc(fp)) { // While is a number or is the first decimal point '.' seen, add to buffer  and increment index
-            buf[index++] = c;
-            if (c == '.') {  // If decimal is seen (has to be first), change flag and change ID to real
-                decimal = 0;
-                id = TOKEN_REAL;
+        token->type = TOKEN_REAL;
+        for (end = i + 1; end < length && isdigit((unsigned char) data[end]); end++);
+    } else if (isdigit(c)) {
+        token->type = TOKEN_INT;
+        for (end = i + 1; end < length; end++) { // Digits and the first decimal point seen
+            if (data[end] == '.' && token->type == TOKEN_INT) {
+                token->type = TOKEN_REAL;
+            } else if (!isdigit((unsigned char) data[end])) {
+                break;
             }
         }
-        ungetc(c, fp);      // Roll position in fp back to allow proper reading
-        buf[index] = 0;     // End Token Value
     } else {
         switch (c) {
             case '(':
-                index++;
-                token.type = TOKEN_OPENP;
-                unread = token;
-                return token;
+                token->type = TOKEN_OPENP;
+                *used = start + 1;
+                return 1;
                 
             case ')':
-                index++;
-                token.type = TOKEN_CLOSEP;
-                unread = token;
-                return token;
+                token->type = TOKEN_CLOSEP;
+                *used = start + 1;
+                return 1;
                 
             case '[':
-                index++;
-                token.type = TOKEN_OPENB;
-                unread = token;
-                return token;
+                token->type = TOKEN_OPENB;
+                *used = start + 1;
+                return 1;
                 
             case ']':
-                index++;
-                token.type = TOKEN_CLOSEB;
-                unread = token;
-                return token;
+                token->type = TOKEN_CLOSEB;
+                *used = start + 1;
+                return 1;
                 
             case '\'':
-                index++;
-                token.type = TOKEN_QUOTE;
-                unread = token;
-                return token;
+                token->type = TOKEN_QUOTE;
+                *used = start + 1;
+                return 1;
                 
             case '`':
-                index++;
-                token.type = TOKEN_BQUOTE;
-                unread = token;
-                return token;
+                token->type = TOKEN_BQUOTE;
+                *used = start + 1;
+                return 1;
                 
             case ',':
-                index++;
-                token.type = TOKEN_COMMA;
-                unread = token;
-                return token;
+                token->type = TOKEN_COMMA;
+                *used = start + 1;
+                return 1;
                 
-            case '"':
-                id = TOKEN_STRING;
-                for (c = getc(fp); c != '"'; c = getc(fp)) { // While c is not a closed quote
-                    if (c == '\\') {    // Escape char, skip and copy
-                        buf[index++] = getc(fp);
-                    } else {
-                        buf[index++] = c;
+            case '"': {
+                size_t j = start + 1;
+                size_t escapes = 0;
+                while (j < length && data[j] != '"') { // Find the closing quote, stepping over escapes
+                    if (data[j] == '\\') {
+                        escapes++;
+                        j++;
                     }
+                    j++;
                 }
-                buf[index] = 0;     // End Token Value
-                break;
-            case '#':
-                token.type = TOKEN_CHAR;
-                char slash = getc(fp);
-                token.value.c = getc(fp);
-                if (slash != '\\') {
-                    fail("Poorly Formatted Character");
+                if (j >= length) {
+                    if (!eof) {
+                        return 0;
+                    }
+                    token->type = TOKEN_INVALID;
+                    token->value.e = '"';
+                    *used = length;
+                    return 1;
                 }
-                return token;
-                
-            default:
-                token.type = TOKEN_INVALID;
-                if (isspace(c)) {    // Valid Token break (whitespace or ';')
-                    token.value.e = 0;
-                } else {            // Invalid Token type (char not valid)
-                    token.value.e = c;
+                char *str = malloc(j - start - escapes);
+                size_t n = 0;
+                for (size_t k = start + 1; k < j; k++) {
+                    if (data[k] == '\\') { // Escape char, skip and copy
+                        k++;
+                    }
+                    str[n++] = data[k];
                 }
+                str[n] = 0;
+                token->type = TOKEN_STRING;
+                token->value.str = str;
+                *used = j + 1;
+                return 1;
+            }
                 
-                if (c == ';') {
-                    for (c = getc(fp);  (c != EOF && c != '\n'); c = getc(fp)); // If ';' then rest of line is comment, keep going until '\n' or EOF is seen
-                    ungetc(c, fp);      // Roll position in fp back to allow proper reading
-                    token.value.e = 0;
+            default: // '#'
+                if (start + 2 >= length) {
+                    if (!eof) {
+                        return 0;
+                    }
+                    token->type = TOKEN_INVALID;
+                    token->value.e = '#';
+                    *used = length;
+                    return 1;
                 }
-                while (token.type == TOKEN_INVALID) {
-                    token = readToken(fp);
-                    
+                *used = start + 3;
+                if (data[start + 1] != '\\') {
+                    token->type = TOKEN_INVALID;
+                    token->value.e = '#';
+                    return 1;
                 }
-                return token;
+                token->type = TOKEN_CHAR;
+                token->value.c = data[start + 2];
+                return 1;
         }
     }
     
-    // If it reaches the end of the if without returning, it is of type INT, REAL, or TOKEN_SYMBOL, that is given
-    
-    
-    token.type = id;
-    
-    switch (id) {
-        case TOKEN_INT: // if INT, atoi()
-            token.value.i = atoi(buf);
-            break;
-            
-        case TOKEN_REAL: // if REAL, atof()
-            token.value.r = atof(buf);
-            break;
-            
-        case TOKEN_SYMBOL: // if SYMBOL, write the buffer (via struniq)
-            token.value.s = struniq(buf);
-            break;
-            
-        case TOKEN_STRING: // if STRING, strdup
-            token.value.str = strdup(buf);
-            break;
-            
-        default:
-            break;
+    // INT, REAL or SYMBOL, complete only once a character past it has been seen
+    if (end == length && !eof) {
+        return 0;
     }
-    
-    unread = token;
-    return token;
-}
-
-void unreadToken(Token token) {
-    assert(unreadPresent == 0);
-    unread = token;
-    unreadPresent = 1;
+    finishToken(token, data + start, end - start);
+    *used = end;
+    return 1;
 }
 
 void printToken(Token token) {
@@ -287,42 +318,37 @@ void printToken(Token token) {
     }
 }
 
-void printChar(unsigned char c) {
-    char *str;
+const char *charName(unsigned char c) {
     switch (c) {
         case 0: // Doesn't work, 0 is used as reference else where
-            str = "null";
-            break;
+            return "null";
             
         case 7:
-            str = "bell";
-            break;
+            return "bell";
             
         case '\t':
-            str = "tab";
-            break;
+            return "tab";
         
         case '\n':
-            str = "newline";
-            break;
+            return "newline";
             
         case ' ':
-            str = "space";
-            break;
+            return "space";
             
         default:
-        {
-            if (isprint(c)) {
-                printf("#\\%c", c);
-                return;
-            } else {
-                printf("#\\%03o", c);
-                return;
-            }
-            
-        }
+            return NULL;
+    }
+}
+
+void printChar(unsigned char c) {
+    const char *str = charName(c);
+    if (str != NULL) {
+        printf("#\\%s", str);
+    } else if (isprint(c)) {
+        printf("#\\%c", c);
+    } else {
+        printf("#\\%03o", c);
     }
-    printf("#\\%s", str);
 }
 
 const char *tokenName(TokenType type) {
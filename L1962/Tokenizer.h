@@ -13,6 +13,7 @@
 #include <string.h>
 #include <ctype.h>
 #include <stdlib.h>
+#include <errno.h>
 #include <assert.h>
 #include "struniq.h"
 #include "try.h"
@@ -62,19 +63,29 @@ typedef struct {
 } Token;
 
 /**
-    Reads a token and only one token
- @param fp   The file pointer for the file to be read and tokenized
- @return The next Token in the file as a Token struct
+    Checks if a character is part of the allowed character set for the beginning of a symbol token
+ @param c   The character to check
+ @return True if in set, false if not
  */
-
-Token readToken(FILE *fp);
+int isSymbol(int c);
 
 /**
-    Unreads a token and only one token
- @param token The token to unread
+    Checks if a character is part of the allowed character set for the contiuation of a symbol token
+ @param c   The character to check
+ @return True if in set, false if not
  */
+int isSymbolContinue(int c);
 
-void unreadToken(Token token);
+/**
+    Scans one token from the front of a block of input, keeping no state between calls so any number of readers can use it at once
+ @param data The input, which need not be NUL terminated
+ @param length The number of characters in data
+ @param eof True if no more input will follow data, so a token running to the end is complete
+ @param token Set to the token when one is found, TOKEN_END at the end of input, TOKEN_INVALID (with the offending char) for a malformed string or character
+ @param used Set to the number of characters consumed, when no token is found this is the whitespace and comments that can be dropped
+ @return True if a token was found, false if more input is needed to finish it
+ */
+int scanToken(const char *data, size_t length, int eof, Token *token, size_t *used);
 
 /**
     Prints a token according to style
@@ -82,6 +93,13 @@ void unreadToken(Token token);
  */
 void printToken(Token token);
 
+/**
+    Gets the name of a char that is written out by name (#\space)
+ @param c   The char
+ @return The name or NULL if the char is written as itself
+ */
+const char *charName(unsigned char c);
+
 /**
     Prints a char according to style
  @param c   The char to print
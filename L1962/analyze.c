@@ -0,0 +1,1594 @@
+//
+//  analyze.c
+//      Analysis pass, turns SExprs into trees of nodes that run without re-inspecting the list structure
+//  L1962
+//
+
+#define _GNU_SOURCE // PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP
+
+#include <string.h>
+#include <pthread.h>
+
+#include "analyze.h"
+#include "eval.h"
+#include "parallel.h"
+#include "records.h"
+
+extern inline SExpr runNode(Node *node, SExpr env);
+
+Node *makeNode(NodeFunction run, size_t count) {
+    Node *node = calloc(1, sizeof(Node));
+    node->run = run;
+    node->count = count;
+    if (count > 0) {
+        node->children = malloc(count * sizeof(Node *));
+    }
+    return node;
+}
+
+SExpr scopeOf(SExpr env) {
+    SExpr scope = NILObj;
+    SExpr last = NILObj;
+    for (SExpr current = env; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr cell = consToSExpr(car(uncheckedCar(current)), NILObj);
+        if (isNIL(last)) {
+            scope = cell;
+        } else {
+            last.cons->cdr = cell;
+        }
+        last = cell;
+    }
+    return scope;
+}
+
+/**
+    The scope of a lambda body, binding the parameters exactly as evalLambda does (private)
+ @param params The parameter list, possibly dotted
+ @param scope The scope of the lambda's environment
+ @return The scope of the body
+ */
+static SExpr bindParams(SExpr params, SExpr scope) {
+    SExpr param;
+    for (param = params; param.type == CONS; param = uncheckedCdr(param)) {
+        scope = consToSExpr(uncheckedCar(param), scope);
+    }
+    if (param.type == SYMBOL) {
+        scope = consToSExpr(param, scope);
+    } else if (param.type != NIL) {
+        fail("Illegal type at end of lambda parameter list: %s", SExprName(param.type));
+    }
+    return scope;
+}
+
+/**
+    Counts the elements of a proper list (private)
+ @param list The list
+ @return The number of elements
+ */
+static size_t properLength(SExpr list) {
+    size_t count = 0;
+    for (; isCONS(list); list = uncheckedCdr(list)) {
+        count++;
+    }
+    check(isNIL(list));
+    return count;
+}
+
+// Constants
+
+/**
+    Self-evaluating values and quote (private)
+ */
+static SExpr runConstant(Node *node, SExpr env) {
+    return node->value;
+}
+
+/**
+    Makes a constant node (private)
+ @param value The value
+ @return The node
+ */
+static Node *constantNode(SExpr value) {
+    Node *node = makeNode(runConstant, 0);
+    node->value = value;
+    return node;
+}
+
+/**
+    A call to a pure builtin on constants, folded during analysis (private)
+    index holds the pureVersion it was folded under, the call itself is kept to fall back on
+ */
+static SExpr runFolded(Node *node, SExpr env) {
+    if (__builtin_expect(pureVersion() == node->index, 1)) {
+        return node->value;
+    }
+    return runNode(node->children[0], env);
+}
+
+/**
+    Checks if a node has the same value every time it runs, without side effects (private)
+ @param node The node
+ @return 1 if node->value is its value
+ */
+static int isConstant(Node *node) {
+    return node->run == runConstant || node->run == runFolded;
+}
+
+// Variables
+
+/**
+    Reads a cache slot, a consistent snapshot or nothing (private)
+ @param binding The slot
+ @return The cached cell or NULL if the slot is empty, being written or holds another epoch
+ */
+static Cons *cachedCell(GlobalBinding *binding) {
+    uint64_t sequence = __atomic_load_n(&binding->sequence, __ATOMIC_ACQUIRE);
+    if (sequence & 1) {
+        return NULL;
+    }
+    uint64_t epoch = __atomic_load_n(&binding->epoch, __ATOMIC_RELAXED);
+    Cons *cell = __atomic_load_n(&binding->cell, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (epoch != globalEpoch || __atomic_load_n(&binding->sequence, __ATOMIC_RELAXED) != sequence) {
+        return NULL;
+    }
+    return cell;
+}
+
+/**
+    The global binding of a node's variable, from the node's cache when it was filled under the current epoch (private)
+    A miss overwrites the slot holding the older epoch in place, if another thread is writing it the lookup is just not cached
+ @param node The node, value is the name
+ @return The (name . value) cell or NIL if there is no global binding
+ */
+static SExpr globalCell(Node *node) {
+    Cons *cached = cachedCell(&node->cache[0]);
+    if (cached == NULL) {
+        cached = cachedCell(&node->cache[1]);
+    }
+    if (__builtin_expect(cached != NULL, 1)) {
+        SExpr cell;
+        cell.type = CONS;
+        cell.cons = cached;
+        return cell;
+    }
+    SExpr cell = assq(node->value, global);
+    if (!isNIL(cell)) {
+        uint64_t epoch0 = __atomic_load_n(&node->cache[0].epoch, __ATOMIC_RELAXED);
+        uint64_t epoch1 = __atomic_load_n(&node->cache[1].epoch, __ATOMIC_RELAXED);
+        GlobalBinding *binding = &node->cache[(epoch1 < epoch0) ? 1 : 0];
+        uint64_t sequence = __atomic_load_n(&binding->sequence, __ATOMIC_RELAXED);
+        if (!(sequence & 1) && __atomic_compare_exchange_n(&binding->sequence, &sequence, sequence + 1, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            __atomic_store_n(&binding->epoch, globalEpoch, __ATOMIC_RELAXED);
+            __atomic_store_n(&binding->cell, cell.cons, __ATOMIC_RELAXED);
+            __atomic_store_n(&binding->sequence, sequence + 2, __ATOMIC_RELEASE);
+        }
+    }
+    return cell;
+}
+
+/**
+    The binding of a local variable from its lexical address, searched for if the environment is not shaped as analyzed (private)
+ @param env The local environment
+ @param index The address
+ @param name The name
+ @return The (name . value) cell or NIL if it is not bound locally
+ */
+static SExpr cellAt(SExpr env, size_t index, SExpr name) {
+    SExpr current = env;
+    for (size_t i = 0; i < index && isCONS(current); i++) {
+        current = uncheckedCdr(current);
+    }
+    if (isCONS(current)) {
+        SExpr cell = uncheckedCar(current);
+        if (isCONS(cell) && isSYMBOL(uncheckedCar(cell)) && uncheckedCar(cell).symbol == name.symbol) {
+            return cell;
+        }
+    }
+    return assq(name, env);
+}
+
+/**
+    The binding of a local variable node (private)
+ @param node The node, value is the name and index the address
+ @param env The local environment
+ @return The (name . value) cell or NIL if it is not bound locally
+ */
+static SExpr localCell(Node *node, SExpr env) {
+    return cellAt(env, node->index, node->value);
+}
+
+/**
+    Global variable reference (private)
+ */
+static SExpr runGlobal(Node *node, SExpr env) {
+    SExpr cell = globalCell(node);
+    if (isNIL(cell)) {
+        fail("No Matching Variable Found in Environment: %s", node->value.symbol);
+    }
+    return uncheckedCdr(cell);
+}
+
+/**
+    Local variable reference (private)
+ */
+static SExpr runLocal(Node *node, SExpr env) {
+    SExpr cell = localCell(node, env);
+    if (isNIL(cell)) {
+        return runGlobal(node, env);
+    }
+    return uncheckedCdr(cell);
+}
+
+/**
+    set! of a global (private)
+ */
+static SExpr runSetGlobal(Node *node, SExpr env) {
+    SExpr value = runNode(node->children[0], env);
+    SExpr cell = globalCell(node);
+    if (isNIL(cell)) {
+        return evalSETBang(node->value, value, NILObj); // Adds the binding
+    }
+    setGlobalCell(cell, value);
+    return node->value;
+}
+
+/**
+    set! of a local (private)
+ */
+static SExpr runSetLocal(Node *node, SExpr env) {
+    SExpr value = runNode(node->children[0], env);
+    SExpr cell = localCell(node, env);
+    if (isNIL(cell)) {
+        return evalSETBang(node->value, value, NILObj);
+    }
+    cell.cons->cdr = value;
+    return node->value;
+}
+
+/**
+    Adds an item at the end of a list (private)
+ @param list The list
+ @param item The item
+ @return The list, a new one if it was empty
+ */
+static SExpr appendItem(SExpr list, SExpr item) {
+    SExpr cell = consToSExpr(item, NILObj);
+    if (isNIL(list)) {
+        return cell;
+    }
+    SExpr last = list;
+    while (isCONS(uncheckedCdr(last))) {
+        last = uncheckedCdr(last);
+    }
+    last.cons->cdr = cell;
+    return list;
+}
+
+/**
+    Resolves a name to the lexical address of its local binding (private)
+    A scope entry that is a CONS marks a lambda boundary, (names . addresses) of what that lambda captures, which sit
+    right after its own bindings in its environment. A name found further out is added to the captures, and resolved
+    in turn in the scope the lambda is made in, so every enclosing lambda captures it too
+ @param name The name
+ @param scope The scope
+ @param index Set to the address
+ @return 1 if the name is bound locally, 0 for a global
+ */
+static int resolve(SExpr name, SExpr scope, size_t *index) {
+    size_t position = 0;
+    for (SExpr current = scope; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr entry = uncheckedCar(current);
+        if (isCONS(entry)) {
+            size_t k = 0;
+            for (SExpr names = uncheckedCar(entry); isCONS(names); names = uncheckedCdr(names), k++) {
+                if (uncheckedCar(names).symbol == name.symbol) {
+                    *index = position + k;
+                    return 1;
+                }
+            }
+            size_t outer = 0;
+            if (!resolve(name, uncheckedCdr(current), &outer)) {
+                return 0;
+            }
+            SExpr address = { INT };
+            address.i = (int64_t) outer;
+            entry.cons->car = appendItem(uncheckedCar(entry), name);
+            entry.cons->cdr = appendItem(uncheckedCdr(entry), address);
+            *index = position + k;
+            return 1;
+        }
+        if (isSYMBOL(entry) && entry.symbol == name.symbol) {
+            *index = position;
+            return 1;
+        }
+        position++;
+    }
+    return 0;
+}
+
+/**
+    Makes a variable reference or set! node, local if the name is in scope (private)
+ @param name The name
+ @param scope The scope
+ @param value The node of the value for set!, NULL for a reference
+ @return The node
+ */
+static Node *variableNode(SExpr name, SExpr scope, Node *value) {
+    size_t index = 0;
+    int local = resolve(name, scope, &index);
+    Node *node;
+    if (value == NULL) {
+        node = makeNode(local ? runLocal : runGlobal, 0);
+    } else {
+        node = makeNode(local ? runSetLocal : runSetGlobal, 1);
+        node->children[0] = value;
+    }
+    node->value = name;
+    node->index = index;
+    return node;
+}
+
+// Sequences
+
+/**
+    progn, begin, and lambda bodies (private)
+ */
+static SExpr runProgn(Node *node, SExpr env) {
+    SExpr result = NILObj;
+    for (size_t i = 0; i < node->count; i++) {
+        result = runNode(node->children[i], env);
+    }
+    return result;
+}
+
+/**
+    Analyzes a list of expressions run in order for the value of the last (private)
+ @param exprs The expressions
+ @param scope The scope
+ @return The node
+ */
+static Node *analyzeProgn(SExpr exprs, SExpr scope) {
+    Node *node = makeNode(runProgn, 0);
+    size_t count = 0;
+    for (SExpr current = exprs; isCONS(current); current = uncheckedCdr(current)) {
+        count++;
+    }
+    node->count = count;
+    node->children = malloc((count > 0 ? count : 1) * sizeof(Node *));
+    size_t i = 0;
+    for (SExpr current = exprs; isCONS(current); current = uncheckedCdr(current)) {
+        node->children[i++] = analyze(uncheckedCar(current), scope);
+    }
+    return node;
+}
+
+// Lambdas and definitions
+
+/**
+    lambda, makes a closure sharing the analyzed body (private)
+    The closure's environment is flat, only the binding cells of the variables it captures in the order the body expects,
+    so set! through the closure still reaches the original binding
+ */
+static SExpr runLambda(Node *node, SExpr env) {
+    SExpr captured = NILObj;
+    SExpr last = NILObj;
+    SExpr names = uncheckedCar(node->value);
+    SExpr addresses = uncheckedCdr(node->value);
+    for (; isCONS(names); names = uncheckedCdr(names), addresses = uncheckedCdr(addresses)) {
+        SExpr cell = cellAt(env, (size_t) uncheckedCar(addresses).i, uncheckedCar(names));
+        if (isNIL(cell)) {
+            cell = consToSExpr(NILObj, NILObj); // Keeps the addresses after it right, never matches a name
+        }
+        cell = consToSExpr(cell, NILObj);
+        if (isNIL(last)) {
+            captured = cell;
+        } else {
+            last.cons->cdr = cell;
+        }
+        last = cell;
+    }
+    SExpr expr = lambdaToSExpr(node->params, node->exprs, captured);
+    expr.lambda->code = node->children[0];
+    return expr;
+}
+
+/**
+    macro, a lambda over the current environment that is called with the unevaluated form and returns its expansion (private)
+ */
+static SExpr runMacro(Node *node, SExpr env) {
+    SExpr expr = runLambda(node, env);
+    expr.type = MACRO;
+    return expr;
+}
+
+/**
+    Makes a node for a lambda, analyzing its body now (private)
+ @param params The parameters
+ @param exprs The body
+ @param scope The scope the lambda is made in
+ @return The node
+ */
+static Node *lambdaNode(SExpr params, SExpr exprs, SExpr scope) {
+    Node *node = makeNode(runLambda, 1);
+    node->params = params;
+    node->exprs = exprs;
+    node->value = consToSExpr(NILObj, NILObj); // Lambda boundary, the captures are filled in while the body is analyzed
+    node->children[0] = analyzeProgn(exprs, bindParams(params, consToSExpr(node->value, scope)));
+    return node;
+}
+
+Node *lambdaCode(Lambda *lambda) {
+    Node *code = __atomic_load_n(&lambda->code, __ATOMIC_ACQUIRE);
+    if (code == NULL) {
+        Node *analyzed = analyzeProgn(lambda->exprs, bindParams(lambda->params, scopeOf(lambda->env)));
+        if (__atomic_compare_exchange_n(&lambda->code, &code, analyzed, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            code = analyzed;
+        } // Otherwise another thread got there first and code is its node
+    }
+    return code;
+}
+
+/**
+    define of a variable, evaluated in the global environment (private)
+ */
+static SExpr runDefine(Node *node, SExpr env) {
+    SExpr value = isNIL(node->exprs) ? NILObj : runNode(node->children[0], NILObj);
+    return evalSETBang(node->value, value, NILObj);
+}
+
+/**
+    define of a function or macro (private)
+ */
+static SExpr runDefineLambda(Node *node, SExpr env) {
+    SExpr lambda = runNode(node->children[0], NILObj);
+    return evalSETBang(node->value, lambda, NILObj);
+}
+
+/**
+    Makes a node for define, defun and defvar (private)
+ @param name The name being defined
+ @param params The parameters of a function, or INVALID for a variable
+ @param exprs The body of a function, or the list holding the value of a variable (NIL for none)
+ @return The node
+ */
+static Node *defineNode(SExpr name, SExpr params, SExpr exprs) {
+    check(isSYMBOL(name));
+    Node *node;
+    if (params.type == INVALID) {
+        node = makeNode(runDefine, 1);
+        node->exprs = exprs;
+        node->children[0] = isNIL(exprs) ? NULL : analyze(car(exprs), NILObj);
+    } else {
+        node = makeNode(runDefineLambda, 1);
+        node->children[0] = lambdaNode(params, exprs, NILObj);
+    }
+    node->value = name;
+    return node;
+}
+
+/**
+    defstruct and define-record-type, the type is made every time it runs (private)
+    value is the type name, params (constructor . predicate), exprs the field specs and index whether the name is bound
+ */
+static SExpr runDefineRecord(Node *node, SExpr env) {
+    return defineRecordType(node->value, uncheckedCar(node->params), uncheckedCdr(node->params), node->exprs, (int) node->index);
+}
+
+/**
+    Makes a symbol from a name with a prefix and suffix (private)
+ @param prefix The prefix
+ @param name The name
+ @param suffix The suffix
+ @return The symbol
+ */
+static SExpr joinSymbol(const char *prefix, const char *name, const char *suffix) {
+    size_t prefixLength = strlen(prefix);
+    size_t nameLength = strlen(name);
+    size_t suffixLength = strlen(suffix);
+    char *joined = malloc(prefixLength + nameLength + suffixLength + 1);
+    memcpy(joined, prefix, prefixLength);
+    memcpy(joined + prefixLength, name, nameLength);
+    memcpy(joined + prefixLength + nameLength, suffix, suffixLength + 1);
+    SExpr symbol = makeSymbol(joined);
+    free(joined);
+    return symbol;
+}
+
+/**
+    Makes a node for a record type (private)
+ @param name The type name
+ @param constructor (name fields...), or NIL for none
+ @param predicate The predicate name, or NIL for none
+ @param fields The list of (field [accessor [modifier]])
+ @param bindName Bind the type name to the descriptor
+ @return The node
+ */
+static Node *recordNode(SExpr name, SExpr constructor, SExpr predicate, SExpr fields, int bindName) {
+    check(isSYMBOL(name));
+    check(isNIL(predicate) || isSYMBOL(predicate));
+    for (SExpr current = fields; isCONS(current); current = uncheckedCdr(current)) {
+        check(isCONS(uncheckedCar(current)) && properLength(uncheckedCar(current)) <= 3);
+    }
+    Node *node = makeNode(runDefineRecord, 0);
+    node->value = name;
+    node->params = consToSExpr(constructor, predicate);
+    node->exprs = fields;
+    node->index = (size_t) bindName;
+    return node;
+}
+
+/**
+    Makes a node for (defstruct name fields...), which defines make-name taking every field in order, name?, name-field and set-name-field! (private)
+ @param name The type name
+ @param slots The field names
+ @return The node
+ */
+static Node *defstructNode(SExpr name, SExpr slots) {
+    check(isSYMBOL(name));
+    SExpr fields = NILObj;
+    SExpr last = NILObj;
+    for (SExpr current = slots; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr slot = uncheckedCar(current);
+        check(isSYMBOL(slot));
+        SExpr accessor = joinSymbol(name.symbol, "-", slot.symbol);
+        SExpr modifier = joinSymbol("set-", accessor.symbol, "!");
+        SExpr cell = consToSExpr(consToSExpr(slot, consToSExpr(accessor, consToSExpr(modifier, NILObj))), NILObj);
+        if (isNIL(last)) {
+            fields = cell;
+        } else {
+            last.cons->cdr = cell;
+        }
+        last = cell;
+    }
+    SExpr constructor = consToSExpr(joinSymbol("make-", name.symbol, ""), slots);
+    return recordNode(name, constructor, joinSymbol(name.symbol, "?", ""), fields, 0);
+}
+
+/**
+    Makes a node for (define-record-type name (constructor fields...) predicate (field accessor [modifier])...)
+    The constructor may also be a bare name taking every field, or NIL for none (private)
+ @param spec The form without define-record-type
+ @return The node
+ */
+static Node *defineRecordTypeNode(SExpr spec) {
+    SExpr name = car(spec);
+    SExpr constructor = cadr(spec);
+    if (isSYMBOL(constructor)) {
+        SExpr fields = NILObj;
+        SExpr last = NILObj;
+        for (SExpr current = cdr(cddr(spec)); isCONS(current); current = uncheckedCdr(current)) {
+            SExpr cell = consToSExpr(car(uncheckedCar(current)), NILObj);
+            if (isNIL(last)) {
+                fields = cell;
+            } else {
+                last.cons->cdr = cell;
+            }
+            last = cell;
+        }
+        constructor = consToSExpr(constructor, fields);
+    } else {
+        check(isLIST(constructor));
+    }
+    return recordNode(name, constructor, car(cddr(spec)), cdr(cddr(spec)), 1);
+}
+
+// Conditionals
+
+/**
+    if (private)
+ */
+static SExpr runIf(Node *node, SExpr env) {
+    if (!isNIL(runNode(node->children[0], env))) {
+        return runNode(node->children[1], env);
+    } else {
+        return runNode(node->children[2], env);
+    }
+}
+
+/**
+    cond, children are test and body pairs, a NULL body returns the test's value (private)
+ */
+static SExpr runCond(Node *node, SExpr env) {
+    for (size_t i = 0; i < node->count; i += 2) {
+        SExpr test = runNode(node->children[i], env);
+        if (!isNIL(test)) {
+            return (node->children[i + 1] == NULL) ? test : runNode(node->children[i + 1], env);
+        }
+    }
+    return NILObj;
+}
+
+/**
+    Makes a node for cond, clauses with a constant false test are dropped and a constant true test ends it (private)
+ @param clauses The (test body...) clauses
+ @param scope The scope
+ @return The node
+ */
+static Node *condNode(SExpr clauses, SExpr scope) {
+    Node *node = makeNode(runCond, 2 * properLength(clauses));
+    size_t i = 0;
+    for (SExpr current = clauses; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr clause = uncheckedCar(current);
+        Node *test = analyze(car(clause), scope);
+        if (test->run == runConstant && isNIL(test->value)) {
+            continue;
+        }
+        node->children[i++] = test;
+        node->children[i++] = isNIL(cdr(clause)) ? NULL : analyzeProgn(cdr(clause), scope);
+        if (test->run == runConstant) {
+            break;
+        }
+    }
+    node->count = i;
+    if (i == 0) {
+        return constantNode(NILObj);
+    } else if (i == 2 && node->children[0]->run == runConstant) {
+        return (node->children[1] == NULL) ? node->children[0] : node->children[1];
+    }
+    return node;
+}
+
+/**
+    when (private)
+ */
+static SExpr runWhen(Node *node, SExpr env) {
+    if (!isNIL(runNode(node->children[0], env))) {
+        return runNode(node->children[1], env);
+    }
+    return NILObj;
+}
+
+/**
+    unless (private)
+ */
+static SExpr runUnless(Node *node, SExpr env) {
+    if (isNIL(runNode(node->children[0], env))) {
+        return runNode(node->children[1], env);
+    }
+    return NILObj;
+}
+
+/**
+    and (private)
+ */
+static SExpr runAnd(Node *node, SExpr env) {
+    for (size_t i = 0; i < node->count; i++) {
+        if (isNIL(runNode(node->children[i], env))) {
+            return NILObj;
+        }
+    }
+    return TObj;
+}
+
+/**
+    or (private)
+ */
+static SExpr runOr(Node *node, SExpr env) {
+    for (size_t i = 0; i < node->count; i++) {
+        if (!isNIL(runNode(node->children[i], env))) {
+            return TObj;
+        }
+    }
+    return NILObj;
+}
+
+/**
+    Makes a node whose children are a list of expressions (private)
+ @param run The node function
+ @param exprs The expressions
+ @param scope The scope
+ @return The node
+ */
+static Node *listNode(NodeFunction run, SExpr exprs, SExpr scope) {
+    Node *node = makeNode(run, properLength(exprs));
+    size_t i = 0;
+    for (SExpr current = exprs; isCONS(current); current = uncheckedCdr(current)) {
+        node->children[i++] = analyze(uncheckedCar(current), scope);
+    }
+    return node;
+}
+
+// Local bindings
+
+/**
+    let, children are the initial values then the body, each value is run in the outer environment and bound as it comes (private)
+ */
+static SExpr runLet(Node *node, SExpr env) {
+    SExpr inner = env;
+    SExpr name = node->params;
+    size_t vars = node->count - 1;
+    for (size_t i = 0; i < vars; i++, name = uncheckedCdr(name)) {
+        inner = acons(uncheckedCar(name), runNode(node->children[i], env), inner);
+    }
+    return runNode(node->children[vars], inner);
+}
+
+/**
+    let*, like let but each value is run with the bindings before it (private)
+ */
+static SExpr runLetStar(Node *node, SExpr env) {
+    SExpr name = node->params;
+    size_t vars = node->count - 1;
+    for (size_t i = 0; i < vars; i++, name = uncheckedCdr(name)) {
+        env = acons(uncheckedCar(name), runNode(node->children[i], env), env);
+    }
+    return runNode(node->children[vars], env);
+}
+
+/**
+    Makes a node for let and let*, a binding is (name value), (name) or name, the last two bind NIL (private)
+ @param run runLet or runLetStar
+ @param bindings The bindings
+ @param body The body
+ @param scope The scope
+ @return The node
+ */
+static Node *letNode(NodeFunction run, SExpr bindings, SExpr body, SExpr scope) {
+    size_t vars = properLength(bindings);
+    Node *node = makeNode(run, vars + 1);
+    node->params = NILObj;
+    SExpr inner = scope;
+    size_t i = 0;
+    for (SExpr current = bindings; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr binding = uncheckedCar(current);
+        SExpr name = isCONS(binding) ? uncheckedCar(binding) : binding;
+        check(isSYMBOL(name));
+        SExpr value = isCONS(binding) ? uncheckedCdr(binding) : NILObj;
+        node->children[i++] = isNIL(value) ? constantNode(NILObj) : analyze(car(value), (run == runLetStar) ? inner : scope);
+        node->params = appendItem(node->params, name);
+        inner = consToSExpr(name, inner);
+    }
+    node->children[vars] = analyzeProgn(body, inner);
+    return node;
+}
+
+// Other forms
+
+/**
+    Fills in a backquote template, running the comma nodes in the order countCommas found them (private)
+ @param expr The template
+ @param node The backquote node
+ @param next The next comma node to run
+ @param env The environment
+ @return The filled in copy of the template
+ */
+static SExpr fillTemplate(SExpr expr, Node *node, size_t *next, SExpr env) {
+    if (!isCONS(expr)) {
+        return expr;
+    }
+    SExpr head = uncheckedCar(expr);
+    if (isSYMBOL(head) && head.symbol == sym_COMMA) {
+        return runNode(node->children[(*next)++], env);
+    }
+    SExpr first = fillTemplate(head, node, next, env);
+    return consToSExpr(first, fillTemplate(uncheckedCdr(expr), node, next, env));
+}
+
+/**
+    Backquote, children are the comma expressions (private)
+ */
+static SExpr runBackquote(Node *node, SExpr env) {
+    size_t next = 0;
+    return fillTemplate(node->value, node, &next, env);
+}
+
+/**
+    Counts the comma expressions of a backquote template, analyzing them into children if there are any (private)
+ @param expr The template
+ @param scope The scope
+ @param children Where to put the nodes, NULL to only count
+ @param count The number found so far
+ */
+static void countCommas(SExpr expr, SExpr scope, Node **children, size_t *count) {
+    if (!isCONS(expr)) {
+        return;
+    }
+    SExpr head = uncheckedCar(expr);
+    if (isSYMBOL(head) && head.symbol == sym_COMMA) {
+        if (children != NULL) {
+            children[*count] = analyze(cadr(expr), scope);
+        }
+        (*count)++;
+        return;
+    }
+    countCommas(head, scope, children, count);
+    countCommas(uncheckedCdr(expr), scope, children, count);
+}
+
+/**
+    future, the node runs on the pool in the environment it was made in (private)
+ */
+static SExpr runFuture(Node *node, SExpr env) {
+    return evalFuture(node->children[0], env);
+}
+
+// Macros
+
+/**
+    Checks if a name is bound in a scope (private)
+ @param name The name
+ @param scope The scope
+ @return 1 if it is bound
+ */
+static int inScope(SExpr name, SExpr scope) {
+    for (SExpr current = scope; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr entry = uncheckedCar(current);
+        if (isSYMBOL(entry) && entry.symbol == name.symbol) { // Lambda boundaries are skipped, their captures are bound further out
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+    Expands a macro call once, the expander gets the unevaluated arguments (private)
+ @param macro The macro
+ @param args The arguments of the call
+ @return The expansion
+ */
+static SExpr expandMacro(SExpr macro, SExpr args) {
+    SExpr expander = macro;
+    expander.type = LAMBDA;
+    return applyFunction(expander, args);
+}
+
+/**
+    Expands every macro call at the head of a form, replacing the form in place with its expansion
+    so the expander only runs the first time a call site is analyzed (private)
+ @param form The form, a CONS
+ @param scope The scope, a locally bound name is never a macro
+ @return The form
+ */
+static SExpr expandForm(SExpr form, SExpr scope) {
+    while (isCONS(form) && isSYMBOL(uncheckedCar(form)) && !inScope(uncheckedCar(form), scope)) {
+        SExpr cell = assq(uncheckedCar(form), global);
+        if (isNIL(cell) || uncheckedCdr(cell).type != MACRO) {
+            break;
+        }
+        SExpr expansion = expandMacro(uncheckedCdr(cell), uncheckedCdr(form));
+        if (!isCONS(expansion)) { // An atom is written in as (progn atom)
+            expansion = consToSExpr(symbolToSExpr(sym_PROGN), consToSExpr(expansion, NILObj));
+        }
+        form.cons->car = uncheckedCar(expansion);
+        form.cons->cdr = uncheckedCdr(expansion);
+    }
+    return form;
+}
+
+// Calls
+
+/**
+    Calls a lambda, evaluating each argument straight into the new environment so no argument array is needed (private)
+    Kept apart from runCall so the call into the body stays a tail call
+ @param node The call node
+ @param lambda The lambda
+ @param env The caller's environment
+ @return The result
+ */
+static SExpr runLambdaCall(Node *node, Lambda *lambda, SExpr env) {
+    SExpr bound = lambda->env;
+    SExpr param;
+    size_t i = 1;
+    for (param = lambda->params; param.type == CONS; param = uncheckedCdr(param), i++) {
+        check(i < node->count);
+        bound = acons(uncheckedCar(param), runNode(node->children[i], env), bound);
+    }
+    if (param.type == SYMBOL) {
+        SExpr rest = NILObj;
+        SExpr last = NILObj;
+        for (; i < node->count; i++) {
+            SExpr cell = consToSExpr(runNode(node->children[i], env), NILObj);
+            if (isNIL(last)) {
+                rest = cell;
+            } else {
+                last.cons->cdr = cell;
+            }
+            last = cell;
+        }
+        bound = acons(param, rest, bound);
+    } else if (param.type == NIL) {
+        check(i == node->count);
+    } else {
+        fail("Illegal type at end of lambda parameter list: %s", SExprName(param.type));
+    }
+    return runNode(lambdaCode(lambda), bound);
+}
+
+/**
+    Calls a builtin with its arguments in an array on the stack (private)
+    Not inlined, so the array never lands in runCall's frame during lambda recursion
+ @param node The call node
+ @param function The builtin
+ @param env The caller's environment
+ @return The result
+ */
+__attribute__((noinline)) static SExpr runBuiltinCall(Node *node, SExpr function, SExpr env) {
+    int argc = (int) node->count - 1;
+    SExpr stack[(argc > 0 && argc <= ARGS_ON_STACK) ? argc : 1]; // Sized to the call
+    SExpr *argv = (argc <= ARGS_ON_STACK) ? stack : malloc(argc * sizeof(SExpr));
+    for (int i = 0; i < argc; i++) {
+        argv[i] = runNode(node->children[i + 1], env);
+    }
+    SExpr result = function.builtin.apply(argc, argv);
+    if (argv != stack) {
+        free(argv);
+    }
+    return result;
+}
+
+/**
+    apply, children are the function, the leading arguments and the list whose elements are spread after them (private)
+    Everything is evaluated once and the arguments go straight into one array for callFunction
+ */
+static SExpr runApply(Node *node, SExpr env) {
+    SExpr function = runNode(node->children[0], env);
+    size_t leading = node->count - 2;
+    SExpr stack[ARGS_ON_STACK];
+    SExpr *argv = stack;
+    if (leading > ARGS_ON_STACK) {
+        argv = malloc(leading * sizeof(SExpr));
+    }
+    for (size_t i = 0; i < leading; i++) {
+        argv[i] = runNode(node->children[i + 1], env);
+    }
+    SExpr spread = runNode(node->children[node->count - 1], env);
+    size_t argc = leading;
+    SExpr current;
+    for (current = spread; isCONS(current); current = uncheckedCdr(current)) {
+        argc++;
+    }
+    check(isNIL(current));
+    if (argc > ARGS_ON_STACK) {
+        SExpr *larger = malloc(argc * sizeof(SExpr));
+        memcpy(larger, argv, leading * sizeof(SExpr));
+        if (argv != stack) {
+            free(argv);
+        }
+        argv = larger;
+    }
+    size_t i = leading;
+    for (current = spread; isCONS(current); current = uncheckedCdr(current)) {
+        argv[i++] = uncheckedCar(current);
+    }
+    SExpr result = callFunction(function, (int) argc, argv);
+    if (argv != stack) {
+        free(argv);
+    }
+    return result;
+}
+
+/**
+    The number of captures of every lambda boundary in a scope (private)
+ @param scope The scope
+ @return The count
+ */
+static size_t captureCount(SExpr scope) {
+    size_t count = 0;
+    for (SExpr current = scope; isCONS(current); current = uncheckedCdr(current)) {
+        if (isCONS(uncheckedCar(current))) {
+            count += properLength(uncheckedCar(uncheckedCar(current)));
+        }
+    }
+    return count;
+}
+
+static pthread_mutex_t expandLock = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP; // Recursive, a macro body can reach another late macro
+
+/**
+    The expansion of a call whose function turned out to be a macro defined after the call site was analyzed (private)
+    The form is expanded in place and analyzed against the call's own scope once, later calls run the same node
+    Expansion rewrites the shared form and adds to the scope's captures, so it happens under expandLock
+    An expansion that needs outer variables the running closure never captured fails rather than read globals,
+    closures made after it capture them
+ @param node The call node, exprs is the form and params its scope
+ @param cache 0 for a jump, whose target is its loop
+ @return The node of the expansion
+ */
+static Node *expandCall(Node *node, int cache) {
+    Node *expansion = cache ? __atomic_load_n(&node->target, __ATOMIC_ACQUIRE) : NULL;
+    if (expansion != NULL) {
+        return expansion;
+    }
+    pthread_mutex_lock(&expandLock);
+    TRY_FINALLY({
+        expansion = cache ? __atomic_load_n(&node->target, __ATOMIC_ACQUIRE) : NULL; // Another thread may have finished first
+        if (expansion == NULL) {
+            size_t captures = captureCount(node->params);
+            expansion = analyze(node->exprs, node->params);
+            if (cache) {
+                __atomic_store_n(&node->target, expansion, __ATOMIC_RELEASE);
+            }
+            if (captureCount(node->params) != captures) {
+                fail("Macro %s was defined after a closure calling it was made and needs variables it did not capture", isSYMBOL(node->value) ? node->value.symbol : "call");
+            }
+        }
+        }, {
+            pthread_mutex_unlock(&expandLock);
+        });
+    return expansion;
+}
+
+/**
+    Function call, arguments are evaluated left to right after the function (private)
+ */
+static SExpr runCall(Node *node, SExpr env) {
+    SExpr function = runNode(node->children[0], env);
+    if (function.type == LAMBDA) {
+        return runLambdaCall(node, function.lambda, env);
+    } else if (function.type == BUILTIN) {
+        return runBuiltinCall(node, function, env);
+    } else if (function.type == MACRO) { // Defined after the call site was analyzed
+        return runNode(expandCall(node, node->run == runCall), env);
+    }
+    if (node->value.type == SYMBOL) {
+        fail("Function %s has no match", node->value.symbol);
+    } else {
+        fail("Function Name not of Type Symbol: %s", SExprName(node->value.type));
+    }
+}
+
+// Loops, the loop variables are bound once and updated in place so iterating allocates nothing, unless a closure
+// or future made in the loop can see them, then every iteration gets fresh bindings as if it were a call
+
+/**
+    Checks if a node makes a closure or future that can see one of some names (private)
+    Closures are not looked inside, their captures already list everything they use from outside. A future keeps
+    the whole environment, so any reference to one of the names in its expression counts
+ @param node The node, NULL for none
+ @param names The names
+ @param inFuture 1 inside a future's expression
+ @return 1 if one of the names may be captured
+ */
+static int capturesAny(Node *node, SExpr names, int inFuture) {
+    if (node == NULL) {
+        return 0;
+    }
+    if (node->run == runLambda || node->run == runMacro) {
+        for (SExpr captured = uncheckedCar(node->value); isCONS(captured); captured = uncheckedCdr(captured)) {
+            if (inScope(uncheckedCar(captured), names)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+    if (inFuture && (node->run == runLocal || node->run == runSetLocal) && inScope(node->value, names)) {
+        return 1;
+    }
+    if (node->run == runFuture) {
+        inFuture = 1;
+    }
+    for (size_t i = 0; i < node->count; i++) {
+        if (capturesAny(node->children[i], names, inFuture)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+    while, children are the test and the body (private)
+ */
+static SExpr runWhile(Node *node, SExpr env) {
+    while (!isNIL(runNode(node->children[0], env))) {
+        runNode(node->children[1], env);
+    }
+    return NILObj;
+}
+
+/**
+    dotimes, children are the count, the body and the result (NULL for NIL), value is the variable
+    and index 1 when the body captures it (private)
+ */
+static SExpr runDotimes(Node *node, SExpr env) {
+    SExpr count = runNode(node->children[0], env);
+    if (count.type != INT) {
+        fail("dotimes count not of Type INT: %s", SExprName(count.type));
+    }
+    SExpr index = { INT };
+    index.i = 0;
+    SExpr inner = acons(node->value, index, env);
+    SExpr cell = uncheckedCar(inner);
+    for (int64_t i = 0; i < count.i; i++) {
+        index.i = i;
+        if (node->index) {
+            inner = acons(node->value, index, env);
+        } else {
+            cell.cons->cdr = index;
+        }
+        runNode(node->children[1], inner);
+    }
+    if (node->children[2] == NULL) {
+        return NILObj;
+    }
+    return runNode(node->children[2], acons(node->value, (count.i > 0) ? count : index, env));
+}
+
+/**
+    dolist, children are the list, the body and the result (NULL for NIL), value is the variable
+    and index 1 when the body captures it (private)
+ */
+static SExpr runDolist(Node *node, SExpr env) {
+    SExpr list = runNode(node->children[0], env);
+    SExpr inner = acons(node->value, NILObj, env);
+    SExpr cell = uncheckedCar(inner);
+    SExpr current;
+    for (current = list; isCONS(current); current = uncheckedCdr(current)) {
+        if (node->index) {
+            inner = acons(node->value, uncheckedCar(current), env);
+        } else {
+            cell.cons->cdr = uncheckedCar(current);
+        }
+        runNode(node->children[1], inner);
+    }
+    check(isNIL(current));
+    if (node->children[2] == NULL) {
+        return NILObj;
+    }
+    return runNode(node->children[2], acons(node->value, NILObj, env));
+}
+
+/**
+    Makes a node for dotimes and dolist, (dotimes (var count [result]) body...) (private)
+ @param run The node function
+ @param spec The (var count [result]) list
+ @param body The body
+ @param scope The scope
+ @return The node
+ */
+static Node *iterationNode(NodeFunction run, SExpr spec, SExpr body, SExpr scope) {
+    SExpr var = car(spec);
+    check(isSYMBOL(var));
+    SExpr inner = consToSExpr(var, scope);
+    Node *node = makeNode(run, 3);
+    node->value = var;
+    node->children[0] = analyze(cadr(spec), scope);
+    node->children[1] = analyzeProgn(body, inner);
+    node->children[2] = isNIL(cddr(spec)) ? NULL : analyze(car(cddr(spec)), inner);
+    node->index = (size_t) capturesAny(node->children[1], consToSExpr(var, NILObj), 0);
+    return node;
+}
+
+/**
+    do, index is the number of variables, children are their inits, their steps (NULL for none), the test,
+    the result and the body, value is T when the loop captures a variable (private)
+ */
+static SExpr runDo(Node *node, SExpr env) {
+    size_t vars = node->index;
+    SExpr stack[(vars > 0 && vars <= ARGS_ON_STACK) ? 2 * vars : 1]; // Cells then step values, sized to the loop
+    SExpr *cells = (vars <= ARGS_ON_STACK) ? stack : malloc(2 * vars * sizeof(SExpr));
+    SExpr *values = cells + vars;
+    for (size_t k = 0; k < vars; k++) {
+        values[k] = runNode(node->children[k], env);
+    }
+    SExpr inner = env;
+    SExpr names = node->params;
+    for (size_t k = 0; k < vars; k++, names = uncheckedCdr(names)) {
+        inner = acons(uncheckedCar(names), values[k], inner);
+        cells[k] = uncheckedCar(inner);
+    }
+    Node **steps = node->children + vars;
+    Node **rest = node->children + 2 * vars;
+    while (isNIL(runNode(rest[0], inner))) {
+        runNode(rest[2], inner);
+        for (size_t k = 0; k < vars; k++) { // All steps see the old values
+            if (steps[k] != NULL) {
+                values[k] = runNode(steps[k], inner);
+            }
+        }
+        if (isNIL(node->value)) {
+            for (size_t k = 0; k < vars; k++) {
+                if (steps[k] != NULL) {
+                    cells[k].cons->cdr = values[k];
+                }
+            }
+        } else {
+            inner = env;
+            names = node->params;
+            for (size_t k = 0; k < vars; k++, names = uncheckedCdr(names)) {
+                inner = acons(uncheckedCar(names), (steps[k] != NULL) ? values[k] : uncheckedCdr(cells[k]), inner);
+                cells[k] = uncheckedCar(inner);
+            }
+        }
+    }
+    if (cells != stack) {
+        free(cells);
+    }
+    return runNode(rest[1], inner);
+}
+
+/**
+    Makes a node for do, (do ((var init [step])...) (test result...) body...) (private)
+ @param specs The (var init [step]) lists
+ @param end The (test result...) list
+ @param body The body
+ @param scope The scope
+ @return The node
+ */
+static Node *doNode(SExpr specs, SExpr end, SExpr body, SExpr scope) {
+    size_t vars = properLength(specs);
+    Node *node = makeNode(runDo, 2 * vars + 3);
+    node->index = vars;
+    node->params = NILObj;
+    SExpr inner = scope;
+    size_t k = 0;
+    for (SExpr current = specs; isCONS(current); current = uncheckedCdr(current), k++) {
+        SExpr spec = uncheckedCar(current);
+        check(isSYMBOL(car(spec)));
+        node->children[k] = analyze(cadr(spec), scope);
+        node->params = appendItem(node->params, car(spec));
+        inner = consToSExpr(car(spec), inner);
+    }
+    k = 0;
+    for (SExpr current = specs; isCONS(current); current = uncheckedCdr(current), k++) {
+        SExpr step = cddr(uncheckedCar(current));
+        node->children[vars + k] = isNIL(step) ? NULL : analyze(car(step), inner);
+    }
+    node->children[2 * vars] = analyze(car(end), inner);
+    node->children[2 * vars + 1] = analyzeProgn(cdr(end), inner);
+    node->children[2 * vars + 2] = analyzeProgn(body, inner);
+    int captured = capturesAny(node->children[2 * vars], node->params, 0) || capturesAny(node->children[2 * vars + 2], node->params, 0);
+    for (k = 0; k < vars && !captured; k++) {
+        captured = capturesAny(node->children[vars + k], node->params, 0);
+    }
+    node->value = captured ? TObj : NILObj;
+    return node;
+}
+
+/**
+    The body of a named let's lambda, runs again while a self tail call jumped (private)
+    A jump that made fresh bindings hands back the environment to go again in as the cons of its INVALID result
+ */
+static SExpr runLoopBody(Node *node, SExpr env) {
+    SExpr result;
+    do {
+        result = runNode(node->children[0], env);
+        if (result.type == INVALID && result.cons != NULL) {
+            env.type = CONS;
+            env.cons = result.cons;
+        }
+    } while (result.type == INVALID);
+    return result;
+}
+
+/**
+    A named let's call to itself in tail position (private)
+    index is how many bindings the body added in front of the parameters, the new values go straight into their cells
+    and the INVALID result tells runLoopBody to go again. If the name no longer holds the loop it is an ordinary call
+ */
+static SExpr runJump(Node *node, SExpr env) {
+    SExpr function = runNode(node->children[0], env);
+    if (function.type != LAMBDA || function.lambda->code != node->target) {
+        return runCall(node, env);
+    }
+    int argc = (int) node->count - 1;
+    SExpr values[(argc > 0) ? argc : 1];
+    for (int i = 0; i < argc; i++) {
+        values[i] = runNode(node->children[i + 1], env);
+    }
+    SExpr current = env;
+    for (size_t i = 0; i < node->index; i++) {
+        current = uncheckedCdr(current);
+    }
+    for (int i = argc - 1; i >= 0; i--) { // Parameters are bound last first
+        uncheckedCar(current).cons->cdr = values[i];
+        current = uncheckedCdr(current);
+    }
+    SExpr again = { INVALID };
+    return again;
+}
+
+/**
+    A named let's call to itself in tail position when a closure or future in the loop captures its variables (private)
+    Like runJump, but binds the new values in fresh cells in front of the lambda's captures and hands that environment
+    to runLoopBody, so what was captured keeps the values of its own iteration
+ */
+static SExpr runFreshJump(Node *node, SExpr env) {
+    SExpr function = runNode(node->children[0], env);
+    if (function.type != LAMBDA || function.lambda->code != node->target) {
+        return runCall(node, env);
+    }
+    int argc = (int) node->count - 1;
+    SExpr values[(argc > 0) ? argc : 1];
+    for (int i = 0; i < argc; i++) {
+        values[i] = runNode(node->children[i + 1], env);
+    }
+    SExpr params = env;
+    for (size_t i = 0; i < node->index; i++) {
+        params = uncheckedCdr(params);
+    }
+    SExpr bound = params;
+    for (int i = 0; i < argc; i++) {
+        bound = uncheckedCdr(bound);
+    }
+    SExpr names[(argc > 0) ? argc : 1];
+    for (int i = argc - 1; i >= 0; i--, params = uncheckedCdr(params)) {
+        names[i] = uncheckedCar(uncheckedCar(params));
+    }
+    for (int i = 0; i < argc; i++) {
+        bound = acons(names[i], values[i], bound);
+    }
+    SExpr again = { INVALID };
+    again.cons = bound.cons;
+    return again;
+}
+
+/**
+    Turns a named let's calls to itself in tail position into jumps, following only tail positions (private)
+ @param node The node in tail position
+ @param depth The number of bindings in front of the parameters here
+ @param name The name of the loop
+ @param params The number of parameters
+ @param address The address of the name's binding past the parameters
+ @param target The loop body the jumps go back to
+ @param jump runJump, or runFreshJump when the loop's variables are captured
+ */
+static void markJumps(Node *node, size_t depth, SExpr name, size_t params, size_t address, Node *target, NodeFunction jump) {
+    if (node == NULL) {
+        return;
+    }
+    if (node->run == runProgn) {
+        if (node->count > 0) {
+            markJumps(node->children[node->count - 1], depth, name, params, address, target, jump);
+        }
+    } else if (node->run == runIf) {
+        markJumps(node->children[1], depth, name, params, address, target, jump);
+        markJumps(node->children[2], depth, name, params, address, target, jump);
+    } else if (node->run == runCond) {
+        for (size_t i = 1; i < node->count; i += 2) {
+            markJumps(node->children[i], depth, name, params, address, target, jump);
+        }
+    } else if (node->run == runWhen || node->run == runUnless) {
+        markJumps(node->children[1], depth, name, params, address, target, jump);
+    } else if (node->run == runLet || node->run == runLetStar) {
+        markJumps(node->children[node->count - 1], depth + node->count - 1, name, params, address, target, jump);
+    } else if (node->run == runCall) {
+        Node *head = node->children[0];
+        if (head->run == runLocal && head->value.symbol == name.symbol && head->index == depth + address && node->count - 1 == params) {
+            node->run = jump;
+            node->index = depth;
+            node->target = target;
+        }
+    }
+}
+
+/**
+    Named let, children are the loop's lambda and the initial values, value is the name (private)
+ */
+static SExpr runNamedLet(Node *node, SExpr env) {
+    SExpr inner = acons(node->value, NILObj, env);
+    SExpr loop = runNode(node->children[0], inner);
+    uncheckedCar(inner).cons->cdr = loop;
+    int argc = (int) node->count - 1;
+    SExpr argv[(argc > 0) ? argc : 1];
+    for (int i = 0; i < argc; i++) {
+        argv[i] = runNode(node->children[i + 1], env);
+    }
+    return evalLambda(loop.lambda, argc, argv);
+}
+
+/**
+    Makes a node for a named let, (let name ((var init)...) body...) (private)
+    The name is bound to a lambda over the variables as usual, its calls to itself in tail position update the variables and loop
+ @param name The name
+ @param pairs The (var init) pairs
+ @param body The body
+ @param scope The scope
+ @return The node
+ */
+static Node *namedLetNode(SExpr name, SExpr pairs, SExpr body, SExpr scope) {
+    size_t count = properLength(pairs);
+    Node *node = makeNode(runNamedLet, 1 + count);
+    node->value = name;
+    SExpr params = NILObj;
+    size_t i = 1;
+    for (SExpr current = pairs; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr pair = uncheckedCar(current);
+        check(isSYMBOL(car(pair)));
+        params = appendItem(params, car(pair));
+        node->children[i++] = analyze(cadr(pair), scope);
+    }
+    Node *loop = lambdaNode(params, body, consToSExpr(name, scope));
+    Node *wrapper = makeNode(runLoopBody, 1);
+    wrapper->children[0] = loop->children[0];
+    loop->children[0] = wrapper;
+    NodeFunction jump = capturesAny(wrapper->children[0], params, 0) ? runFreshJump : runJump;
+    size_t k = 0;
+    for (SExpr captured = uncheckedCar(loop->value); isCONS(captured); captured = uncheckedCdr(captured), k++) {
+        if (uncheckedCar(captured).symbol == name.symbol) { // Only there if the body uses the name
+            markJumps(wrapper->children[0], 0, name, count, count + k, wrapper, jump);
+        }
+    }
+    node->children[0] = loop;
+    return node;
+}
+
+/**
+    Folds a call to a pure builtin whose arguments are all constant, guarded by pureVersion against redefinition (private)
+    A call that fails is left alone so the failure happens when it runs
+ @param node The call node
+ @return The folded node, or the call node if it can't be folded
+ */
+static Node *foldCall(Node *node) {
+    if (node->children[0]->run != runGlobal || node->count - 1 > ARGS_ON_STACK) {
+        return node;
+    }
+    SExpr argv[ARGS_ON_STACK];
+    int argc = (int) node->count - 1;
+    for (int i = 0; i < argc; i++) {
+        if (!isConstant(node->children[i + 1])) {
+            return node;
+        }
+        argv[i] = node->children[i + 1]->value;
+    }
+    uint64_t version = pureVersion(); // Before the lookup, an overwrite after it makes the fold stale rather than wrong
+    SExpr cell = globalCell(node->children[0]);
+    if (isNIL(cell) || !isPureBuiltin(uncheckedCdr(cell))) {
+        return node;
+    }
+    SExpr function = uncheckedCdr(cell);
+    Node *folded = NULL;
+    TRY_CATCH(failure,
+        SExpr value = function.builtin.apply(argc, argv);
+        folded = makeNode(runFolded, 1);
+        folded->value = value;
+        folded->index = version;
+        folded->children[0] = node;
+    ,
+        (void) failure;
+        folded = NULL;
+    );
+    return (folded != NULL) ? folded : node;
+}
+
+/**
+    Analyzes a special form or call (private)
+ @param sexpr The form
+ @param scope The scope
+ @return The node
+ */
+static Node *analyzeForm(SExpr sexpr, SExpr scope) {
+    sexpr = expandForm(sexpr, scope);
+    SExpr head = uncheckedCar(sexpr);
+    if (isSYMBOL(head)) {
+        const char *sym = head.symbol;
+        if (sym == sym_QUOTE) {
+            check(cddr(sexpr).type == NIL);
+            return constantNode(cadr(sexpr));
+        } else if (sym == sym_BQUOTE) {
+            check(cddr(sexpr).type == NIL);
+            size_t commas = 0;
+            countCommas(cadr(sexpr), scope, NULL, &commas);
+            if (commas == 0) { // Hoisted, a template without commas is a quoted literal
+                return constantNode(cadr(sexpr));
+            }
+            Node *node = makeNode(runBackquote, commas);
+            node->value = cadr(sexpr);
+            commas = 0;
+            countCommas(cadr(sexpr), scope, node->children, &commas);
+            return node;
+        } else if (sym == sym_COMMA) {
+            fail("Comma found outside of backquote");
+        } else if (sym == sym_SETBang) {
+            check(cadr(sexpr).type == SYMBOL);
+            return variableNode(cadr(sexpr), scope, analyze(car(cddr(sexpr)), scope));
+        } else if (sym == sym_LAMBDA) {
+            return lambdaNode(cadr(sexpr), cddr(sexpr), scope);
+        } else if (sym == sym_MACRO) {
+            Node *node = lambdaNode(cadr(sexpr), cddr(sexpr), scope);
+            node->run = runMacro;
+            return node;
+        } else if (sym == sym_DEFMACRO) {
+            Node *node = defineNode(cadr(sexpr), car(cddr(sexpr)), cdr(cddr(sexpr)));
+            node->children[0]->run = runMacro;
+            return node;
+        } else if (sym == sym_LET) {
+            if (isSYMBOL(cadr(sexpr))) {
+                return namedLetNode(cadr(sexpr), car(cddr(sexpr)), cdr(cddr(sexpr)), scope);
+            }
+            return letNode(runLet, cadr(sexpr), cddr(sexpr), scope);
+        } else if (sym == sym_LETStar) {
+            return letNode(runLetStar, cadr(sexpr), cddr(sexpr), scope);
+        } else if (sym == sym_WHILE) {
+            Node *node = makeNode(runWhile, 2);
+            node->children[0] = analyze(cadr(sexpr), scope);
+            node->children[1] = analyzeProgn(cddr(sexpr), scope);
+            return node;
+        } else if (sym == sym_DOTIMES || sym == sym_DOLIST) {
+            return iterationNode((sym == sym_DOTIMES) ? runDotimes : runDolist, cadr(sexpr), cddr(sexpr), scope);
+        } else if (sym == sym_DO) {
+            return doNode(cadr(sexpr), car(cddr(sexpr)), cdr(cddr(sexpr)), scope);
+        } else if (sym == sym_DEFSTRUCT) {
+            return defstructNode(cadr(sexpr), cddr(sexpr));
+        } else if (sym == sym_DEFINE_RECORD_TYPE) {
+            return defineRecordTypeNode(cdr(sexpr));
+        } else if (sym == sym_DEFINE) {
+            SExpr id = cadr(sexpr);
+            if (isSYMBOL(id)) {
+                SExpr invalid = { INVALID };
+                return defineNode(id, invalid, cddr(sexpr));
+            } else if (isCONS(id)) {
+                return defineNode(car(id), cdr(id), cddr(sexpr));
+            } else {
+                fail("Invalid define: id is not of type SYMBOL or type CONS");
+            }
+        } else if (sym == sym_DEFUN) {
+            return defineNode(cadr(sexpr), car(cddr(sexpr)), cdr(cddr(sexpr)));
+        } else if (sym == sym_DEFVAR) {
+            SExpr invalid = { INVALID };
+            return defineNode(cadr(sexpr), invalid, cddr(sexpr));
+        } else if (sym == sym_IF) {
+            Node *node = makeNode(runIf, 3);
+            node->children[0] = analyze(cadr(sexpr), scope);
+            node->children[1] = analyze(car(cddr(sexpr)), scope);
+            node->children[2] = isNIL(cdr(cddr(sexpr))) ? constantNode(NILObj) : analyze(cadr(cddr(sexpr)), scope);
+            if (node->children[0]->run == runConstant) {
+                return isNIL(node->children[0]->value) ? node->children[2] : node->children[1];
+            }
+            return node;
+        } else if (sym == sym_COND) {
+            return condNode(cdr(sexpr), scope);
+        } else if (sym == sym_WHEN || sym == sym_UNLESS) {
+            Node *node = makeNode((sym == sym_WHEN) ? runWhen : runUnless, 2);
+            node->children[0] = analyze(cadr(sexpr), scope);
+            node->children[1] = analyzeProgn(cddr(sexpr), scope);
+            if (node->children[0]->run == runConstant) {
+                return (isNIL(node->children[0]->value) == (sym == sym_UNLESS)) ? node->children[1] : constantNode(NILObj);
+            }
+            return node;
+        } else if (sym == sym_AND || sym == sym_OR) {
+            check(!isNIL(cddr(sexpr)));       // Must be a two+ element list
+            return listNode((sym == sym_AND) ? runAnd : runOr, cdr(sexpr), scope);
+        } else if (sym == sym_PROGN || sym == sym_BEGIN) {
+            return analyzeProgn(cdr(sexpr), scope);
+        } else if (sym == sym_APPLY) {
+            check(!isNIL(cddr(sexpr))); // Needs at least the function and the list
+            return listNode(runApply, cdr(sexpr), scope);
+        } else if (sym == sym_FUTURE) {
+            check(isNIL(cddr(sexpr)));
+            Node *node = makeNode(runFuture, 1);
+            node->children[0] = analyze(cadr(sexpr), scope);
+            return node;
+        }
+    }
+
+    Node *node = makeNode(runCall, 1 + properLength(cdr(sexpr)));
+    node->value = head;
+    node->exprs = sexpr;
+    node->params = scope;
+    node->children[0] = analyze(head, scope);
+    size_t i = 1;
+    for (SExpr current = uncheckedCdr(sexpr); isCONS(current); current = uncheckedCdr(current)) {
+        node->children[i++] = analyze(uncheckedCar(current), scope);
+    }
+    return foldCall(node);
+}
+
+Node *analyze(SExpr expr, SExpr scope) {
+    switch (expr.type) {
+        case INVALID: // It's an error
+            fail("SExpr Error: of INVALID type");
+
+        case INT: // Self - Returning
+        case REAL:
+        case NIL:
+        case STRING:
+        case CHAR:
+        case END:
+        case RECORD:
+        case F64VECTOR:
+        case S64VECTOR:
+        case BYTEVECTOR:
+            return constantNode(expr);
+
+        case SYMBOL: // Variable Names
+            return variableNode(expr, scope, NULL);
+
+        case CONS: // Functions and things
+            return analyzeForm(expr, scope);
+
+        default:
+            fail("Default Error, Not of Valid SExpr Type");
+    }
+}
@@ -0,0 +1,83 @@
+//
+//  analyze.h
+//      Analysis pass, turns SExprs into trees of nodes that run without re-inspecting the list structure
+//  L1962
+//
+
+#ifndef analyze_h
+#define analyze_h
+
+#include "SExpr.h"
+
+typedef SExpr (*NodeFunction)(Node *node, SExpr env);
+
+/**
+    GlobalBinding Struct, the (name . value) cell of a global and the epoch it was found under
+    Updated in place under a sequence lock, readers retry the lookup instead of waiting on a writer
+ */
+typedef struct GlobalBinding GlobalBinding;
+struct GlobalBinding {
+    uint64_t sequence;      // Odd while being written
+    uint64_t epoch;
+    Cons *cell;             // NULL until filled
+};
+
+/**
+    Node Struct, one analyzed expression
+    Special forms, argument counts and variable locations are worked out once, running a node only calls its function
+    Nodes are shared by every thread running the code, so the only thing written after analysis is the global cache
+ */
+struct Node {
+    NodeFunction run;
+    SExpr value;            // Constant value, variable name, or the form for nodes that still work on it
+    size_t index;           // For locals, the position of the binding in the environment a-list
+    GlobalBinding cache[2]; // For globals, two slots so two evaluators with their own globals don't evict each other
+    SExpr params;           // Lambda parameters, let names, or the scope of a call
+    SExpr exprs;            // Lambda body, let values, or the form of a call
+    Node **children;
+    size_t count;
+    Node *target;           // For a named let's jumps, the loop body they go back to, for calls a late macro's expansion
+};
+
+/**
+    Runs an analyzed node
+ @param node The node
+ @param env The local environment, shaped like the scope the node was analyzed in
+ @return The value
+ */
+inline SExpr runNode(Node *node, SExpr env) {
+    return node->run(node, env);
+}
+
+/**
+    Makes a node
+ @param run The node function
+ @param count The number of children
+ @return The node, everything else zeroed
+ */
+Node *makeNode(NodeFunction run, size_t count);
+
+/**
+    The scope an environment corresponds to, the list of its names in order
+ @param env The local environment a-list
+ @return The list of symbols
+ */
+SExpr scopeOf(SExpr env);
+
+/**
+    Analyzes an expression
+    Macro calls are expanded here and the calling form is replaced by its expansion, so later analysis of the same code skips the expander
+ @param expr The expression
+ @param scope The names bound in the local environment it will run in, in a-list order
+ @return The node
+ */
+Node *analyze(SExpr expr, SExpr scope);
+
+/**
+    Gets the analyzed body of a lambda, analyzing it on first use for lambdas that were not made by a lambda node (images)
+ @param lambda The lambda
+ @return The body node, run in the environment evalLambda builds
+ */
+Node *lambdaCode(Lambda *lambda);
+
+#endif /* analyze_h */
@@ -0,0 +1,520 @@
+//
+//  binary.c
+//      Compact binary encoding of SExpr data for exchange between processes
+//  L1962
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "binary.h"
+#include "pointerMap.h"
+
+#define BINARY_MAGIC "L1962BIN"
+#define BINARY_MAX_LENGTH ((uint64_t) 1 << 32) // Longest string, bytevector or symbol table a message may hold
+#define BINARY_MAX_DEPTH 10000 // Deepest nesting of lists inside lists, decoding recurses once per level
+
+enum {
+    TAG_NIL = 0,
+    TAG_INT = 1,
+    TAG_REAL = 2,
+    TAG_SYMBOL = 3,
+    TAG_STRING = 4,
+    TAG_CHAR = 5,
+    TAG_LIST = 6,
+    TAG_DEFINE = 7,
+    TAG_REFERENCE = 8,
+    TAG_BYTEVECTOR = 9,
+};
+
+#define BINARY_SEEN 0   // Cons reached once
+#define BINARY_SHARED 1 // Cons reached more than once
+#define BINARY_LABEL 2  // Labels are stored as BINARY_LABEL + n once defined
+
+/**
+    BinaryWriter Struct, the state for encoding one message
+ */
+typedef struct BinaryWriter BinaryWriter;
+struct BinaryWriter {
+    PointerMap symbols;     // symbol -> index in the symbol table
+    PointerMap shared;      // Cons * -> BINARY_SEEN, BINARY_SHARED or a label
+    const char **symbolList;
+    size_t symbolCount;
+    size_t symbolCapacity;
+    size_t labels;
+    Buffer body;
+};
+
+/**
+    Appends an unsigned LEB128 varint (private)
+ @param buffer The buffer
+ @param value The value
+ */
+static void bufferVarint(Buffer *buffer, uint64_t value) {
+    char bytes[10];
+    int n = 0;
+    do {
+        bytes[n] = value & 0x7f;
+        value >>= 7;
+        if (value != 0) {
+            bytes[n] |= 0x80;
+        }
+        n++;
+    } while (value != 0);
+    bufferAppend(buffer, bytes, n);
+}
+
+/**
+    Collects the symbols and finds shared conses with an explicit stack (private)
+ @param writer The writer
+ @param root The SExpr to write
+ */
+static void binaryVisit(BinaryWriter *writer, SExpr root) {
+    size_t count = 0;
+    size_t capacity = 64;
+    SExpr *stack = malloc(capacity * sizeof(SExpr));
+    stack[count++] = root;
+    while (count > 0) {
+        SExpr expr = stack[--count];
+        switch (expr.type) {
+            case CONS:
+                if (pointerMapGet(&writer->shared, expr.cons, NULL)) {
+                    pointerMapPut(&writer->shared, expr.cons, BINARY_SHARED);
+                } else {
+                    pointerMapPut(&writer->shared, expr.cons, BINARY_SEEN);
+                    if (count + 2 > capacity) {
+                        capacity *= 2;
+                        stack = realloc(stack, capacity * sizeof(SExpr));
+                    }
+                    stack[count++] = expr.cons->cdr;
+                    stack[count++] = expr.cons->car;
+                }
+                break;
+                
+            case SYMBOL:
+                if (!pointerMapGet(&writer->symbols, expr.symbol, NULL)) {
+                    pointerMapPut(&writer->symbols, expr.symbol, writer->symbolCount);
+                    if (writer->symbolCount == writer->symbolCapacity) {
+                        writer->symbolCapacity = (writer->symbolCapacity == 0) ? 16 : writer->symbolCapacity * 2;
+                        writer->symbolList = realloc(writer->symbolList, writer->symbolCapacity * sizeof(char *));
+                    }
+                    writer->symbolList[writer->symbolCount++] = expr.symbol;
+                }
+                break;
+                
+            case NIL:
+            case INT:
+            case REAL:
+            case STRING:
+            case BYTEVECTOR:
+            case CHAR:
+                break;
+                
+            default:
+                free(stack);
+                fail("Cannot write an SExpr of type %s in binary", SExprName(expr.type));
+        }
+    }
+    free(stack);
+}
+
+/**
+    Checks if a cons has to be labelled (private)
+ @param writer The writer
+ @param cons The cons
+ @return 1 if it is shared
+ */
+static int binaryShared(BinaryWriter *writer, Cons *cons) {
+    size_t state = BINARY_SEEN;
+    pointerMapGet(&writer->shared, cons, &state);
+    return state != BINARY_SEEN;
+}
+
+/**
+    Encodes a value into the message body, lists are walked iteratively along the cdr (private)
+ @param writer The writer
+ @param expr The SExpr to encode
+ @param depth How many lists the value is nested in, capped like the reader's so what is written can be read
+ */
+static void binaryEncode(BinaryWriter *writer, SExpr expr, size_t depth) {
+    if (depth > BINARY_MAX_DEPTH) {
+        fail("Cannot write an SExpr nested more than %d lists deep in binary", BINARY_MAX_DEPTH);
+    }
+    Buffer *body = &writer->body;
+    switch (expr.type) {
+        case NIL:
+            bufferChar(body, TAG_NIL);
+            break;
+            
+        case INT:
+            bufferChar(body, TAG_INT);
+            bufferVarint(body, ((uint64_t) expr.i << 1) ^ (uint64_t) (expr.i >> 63)); // zigzag
+            break;
+            
+        case REAL:
+            bufferChar(body, TAG_REAL);
+            bufferAppend(body, (const char *) &expr.r, sizeof(double));
+            break;
+            
+        case SYMBOL:
+        {
+            size_t index = 0;
+            pointerMapGet(&writer->symbols, expr.symbol, &index);
+            bufferChar(body, TAG_SYMBOL);
+            bufferVarint(body, index);
+            break;
+        }
+            
+        case STRING:
+        case BYTEVECTOR:
+        {
+            size_t length = stringLength(expr);
+            bufferChar(body, (expr.type == STRING) ? TAG_STRING : TAG_BYTEVECTOR);
+            bufferVarint(body, length);
+            bufferAppend(body, expr.string, length);
+            break;
+        }
+            
+        case CHAR:
+            bufferChar(body, TAG_CHAR);
+            bufferChar(body, expr.c);
+            break;
+            
+        case CONS:
+        {
+            size_t state = BINARY_SEEN;
+            pointerMapGet(&writer->shared, expr.cons, &state);
+            if (state >= BINARY_LABEL) {
+                bufferChar(body, TAG_REFERENCE);
+                bufferVarint(body, state - BINARY_LABEL);
+                break;
+            }
+            if (state == BINARY_SHARED) {
+                bufferChar(body, TAG_DEFINE);
+                bufferVarint(body, writer->labels);
+                pointerMapPut(&writer->shared, expr.cons, BINARY_LABEL + writer->labels);
+                writer->labels++;
+            }
+            size_t n = 1; // Elements up to the tail: NIL, an atom, or a shared cons
+            for (SExpr rest = expr.cons->cdr; rest.type == CONS && !binaryShared(writer, rest.cons); rest = rest.cons->cdr) {
+                n++;
+            }
+            bufferChar(body, TAG_LIST);
+            bufferVarint(body, n);
+            SExpr current = expr;
+            for (size_t i = 0; i < n; i++) {
+                binaryEncode(writer, current.cons->car, depth + 1);
+                current = current.cons->cdr;
+            }
+            binaryEncode(writer, current, depth + 1);
+            break;
+        }
+            
+        default:
+            fail("Cannot write an SExpr of type %s in binary", SExprName(expr.type));
+    }
+}
+
+void binaryWriteHeader(FILE *fp) {
+    fwrite(BINARY_MAGIC, 8, 1, fp);
+}
+
+void binaryWrite(FILE *fp, SExpr expr) {
+    BinaryWriter writer;
+    memset(&writer, 0, sizeof(BinaryWriter));
+    pointerMapInit(&writer.symbols);
+    pointerMapInit(&writer.shared);
+    bufferInit(&writer.body);
+    writer.body.file = fp; // Large bodies stream out in chunks once the symbol table is written
+    
+    binaryVisit(&writer, expr);
+    
+    Buffer *body = &writer.body;
+    bufferVarint(body, writer.symbolCount);
+    for (size_t i = 0; i < writer.symbolCount; i++) {
+        size_t length = strlen(writer.symbolList[i]);
+        bufferVarint(body, length);
+        bufferAppend(body, writer.symbolList[i], length);
+    }
+    binaryEncode(&writer, expr, 0);
+    bufferFlush(body);
+    
+    bufferFree(body);
+    pointerMapFree(&writer.symbols);
+    pointerMapFree(&writer.shared);
+    free(writer.symbolList);
+}
+
+void binaryReaderInit(BinaryReader *reader, FILE *fp) {
+    memset(reader, 0, sizeof(BinaryReader));
+    reader->fp = fp;
+}
+
+void binaryReaderFree(BinaryReader *reader) {
+    free(reader->symbols);
+    free(reader->labels);
+    reader->symbols = NULL;
+    reader->labels = NULL;
+}
+
+/**
+    Reads one byte of a message (private)
+ @param reader The reader
+ @return The byte
+ */
+static int binaryByte(BinaryReader *reader) {
+    int c = getc(reader->fp);
+    if (c == EOF) {
+        fail("Truncated binary data");
+    }
+    return c;
+}
+
+/**
+    Reads an unsigned LEB128 varint (private)
+ @param reader The reader
+ @return The value
+ */
+static uint64_t binaryVarint(BinaryReader *reader) {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = binaryByte(reader);
+        value |= (uint64_t) (c & 0x7f) << shift;
+        if (!(c & 0x80)) {
+            return value;
+        }
+    }
+    fail("Corrupt binary data: varint too long");
+}
+
+/**
+    Checks a length read from the stream before anything is allocated for it, so corrupt data fails cleanly (private)
+    Regular files are also checked against the bytes left in them
+ @param reader The reader
+ @param length The number of bytes (or entries of at least a byte each) that follow
+ */
+static void binaryCheckLength(BinaryReader *reader, uint64_t length) {
+    if (length > BINARY_MAX_LENGTH) {
+        fail("Corrupt binary data: length %llu too large", (unsigned long long) length);
+    }
+    struct stat info;
+    off_t position = ftello(reader->fp);
+    if (position >= 0 && fstat(fileno(reader->fp), &info) == 0 && S_ISREG(info.st_mode) && (off_t) length > info.st_size - position) {
+        fail("Truncated binary data");
+    }
+}
+
+/**
+    Reads bytes into a new NUL terminated string (private)
+ @param reader The reader
+ @param length The number of bytes
+ @return The malloc'ed string
+ */
+static char *binaryBytes(BinaryReader *reader, uint64_t length) {
+    binaryCheckLength(reader, length);
+    char *bytes = malloc(length + 1);
+    if (bytes == NULL) {
+        fail("Out of memory reading binary data");
+    }
+    if (fread(bytes, 1, length, reader->fp) != length) {
+        free(bytes);
+        fail("Truncated binary data");
+    }
+    bytes[length] = 0;
+    return bytes;
+}
+
+/**
+    Reads the bytes of a STRING or BYTEVECTOR straight into its storage (private)
+ @param reader The reader
+ @param type STRING or BYTEVECTOR
+ @return The SExpr
+ */
+static SExpr binaryString(BinaryReader *reader, SExprType type) {
+    uint64_t length = binaryVarint(reader);
+    binaryCheckLength(reader, length);
+    char *bytes = allocString(length);
+    if (bytes == NULL) {
+        fail("Out of memory reading binary data");
+    }
+    if (fread(bytes, 1, length, reader->fp) != length) {
+        free((size_t *) (void *) bytes - 1);
+        fail("Truncated binary data");
+    }
+    SExpr string;
+    string.type = type;
+    string.string = bytes;
+    return string;
+}
+
+/**
+    Decodes one value (private)
+ @param reader The reader
+ @param depth How many lists the value is nested in
+ @return The SExpr
+ */
+static SExpr binaryDecode(BinaryReader *reader, size_t depth) {
+    if (depth > BINARY_MAX_DEPTH) {
+        fail("Corrupt binary data: nesting too deep");
+    }
+    int tag = binaryByte(reader);
+    switch (tag) {
+        case TAG_NIL:
+            return NILObj;
+            
+        case TAG_INT:
+        {
+            uint64_t zigzag = binaryVarint(reader);
+            return intToSExpr((int64_t) (zigzag >> 1) ^ -(int64_t) (zigzag & 1));
+        }
+            
+        case TAG_REAL:
+        {
+            double r;
+            if (fread(&r, sizeof(double), 1, reader->fp) != 1) {
+                fail("Truncated binary data");
+            }
+            return realToSExpr(r);
+        }
+            
+        case TAG_SYMBOL:
+        {
+            uint64_t index = binaryVarint(reader);
+            if (index >= reader->symbolCount) {
+                fail("Corrupt binary data: symbol %llu out of range", (unsigned long long) index);
+            }
+            return symbolToSExpr(reader->symbols[index]);
+        }
+            
+        case TAG_STRING:
+            return binaryString(reader, STRING);
+            
+        case TAG_BYTEVECTOR:
+            return binaryString(reader, BYTEVECTOR);
+            
+        case TAG_CHAR:
+            return charToSExpr(binaryByte(reader));
+            
+        case TAG_REFERENCE:
+        {
+            uint64_t label = binaryVarint(reader);
+            if (label >= reader->labelCount) {
+                fail("Corrupt binary data: label %llu out of range", (unsigned long long) label);
+            }
+            SExpr expr;
+            expr.type = CONS;
+            expr.cons = reader->labels[label];
+            return expr;
+        }
+            
+        case TAG_DEFINE:
+        case TAG_LIST:
+        {
+            int define = (tag == TAG_DEFINE);
+            if (define) {
+                if (binaryVarint(reader) != reader->labelCount || binaryByte(reader) != TAG_LIST) {
+                    fail("Corrupt binary data: bad label definition");
+                }
+            }
+            uint64_t n = binaryVarint(reader);
+            if (n == 0) {
+                fail("Corrupt binary data: empty list");
+            }
+            SExpr head = consToSExpr(NILObj, NILObj); // Allocated before its elements so cycles can refer to it
+            if (define) {
+                if (reader->labelCount == reader->labelCapacity) {
+                    reader->labelCapacity = (reader->labelCapacity == 0) ? 16 : reader->labelCapacity * 2;
+                    reader->labels = realloc(reader->labels, reader->labelCapacity * sizeof(Cons *));
+                }
+                reader->labels[reader->labelCount++] = head.cons;
+            }
+            SExpr current = head;
+            for (uint64_t i = 0; i < n; i++) {
+                current.cons->car = binaryDecode(reader, depth + 1);
+                if (i + 1 < n) {
+                    current.cons->cdr = consToSExpr(NILObj, NILObj);
+                    current = current.cons->cdr;
+                }
+            }
+            current.cons->cdr = binaryDecode(reader, depth + 1);
+            return head;
+        }
+            
+        default:
+            fail("Corrupt binary data: unknown tag %d", tag);
+    }
+}
+
+int binaryRead(BinaryReader *reader, SExpr *expr) {
+    if (!reader->started) {
+        char magic[8];
+        size_t n = fread(magic, 1, 8, reader->fp);
+        if (n == 0) {
+            return 0;
+        }
+        if (n != 8 || memcmp(magic, BINARY_MAGIC, 8) != 0) {
+            fail("Not a binary SExpr stream");
+        }
+        reader->started = 1;
+    }
+    int c = getc(reader->fp);
+    if (c == EOF) {
+        return 0;
+    }
+    ungetc(c, reader->fp);
+    
+    uint64_t count = binaryVarint(reader);
+    binaryCheckLength(reader, count);
+    if (count > reader->symbolCapacity) {
+        reader->symbolCapacity = count;
+        reader->symbols = realloc(reader->symbols, count * sizeof(char *));
+    }
+    reader->symbolCount = 0;
+    for (uint64_t i = 0; i < count; i++) { // Each symbol is interned once per message
+        char *name = binaryBytes(reader, binaryVarint(reader));
+        reader->symbols[reader->symbolCount++] = struniq(name);
+        free(name);
+    }
+    reader->labelCount = 0;
+    *expr = binaryDecode(reader, 0);
+    return 1;
+}
+
+SExpr evalWriteBinary(SExpr args) {
+    check(isNIL(cddr(args)));
+    SExpr expr = car(args);
+    SExpr path = cadr(args);
+    check(path.type == STRING);
+    FILE *fp = fopen(path.string, "wb");
+    if (fp == NULL) {
+        fail("can't open file: %s", path.string);
+    }
+    TRY_FINALLY({
+        binaryWriteHeader(fp);
+        binaryWrite(fp, expr);
+        }, {
+            fclose(fp);
+        });
+    return path;
+}
+
+SExpr evalReadBinary(SExpr args) {
+    check(isNIL(cdr(args)));
+    SExpr path = car(args);
+    check(path.type == STRING);
+    FILE *fp = fopen(path.string, "rb");
+    if (fp == NULL) {
+        fail("can't open file: %s", path.string);
+    }
+    BinaryReader reader;
+    binaryReaderInit(&reader, fp);
+    SExpr expr = NILObj;
+    TRY_FINALLY({
+        binaryRead(&reader, &expr);
+        }, {
+            binaryReaderFree(&reader);
+            fclose(fp);
+        });
+    return expr;
+}
@@ -0,0 +1,86 @@
+//
+//  binary.h
+//      Compact binary encoding of SExpr data for exchange between processes
+//  L1962
+//
+
+#ifndef binary_h
+#define binary_h
+
+#include "SExpr.h"
+
+/*
+    A stream is the 8 byte magic "L1962BIN" followed by messages, one per SExpr
+    A message is a symbol table (varint count, then varint length + bytes for each symbol)
+    followed by one tagged value:
+        NIL | INT zigzag varint | REAL 8 raw bytes | SYMBOL varint index | STRING varint length + bytes
+        | CHAR byte | LIST varint count, count values, tail value | DEFINE varint label, LIST | REFERENCE varint label
+        | BYTEVECTOR varint length + bytes
+    DEFINE/REFERENCE keep shared and circular conses intact
+ */
+
+/**
+    BinaryReader Struct, a streaming decoder that reads one message at a time
+ */
+typedef struct BinaryReader BinaryReader;
+struct BinaryReader {
+    FILE *fp;
+    int started;            // The stream magic has been read
+    const char **symbols;   // Symbol table of the current message
+    size_t symbolCount;
+    size_t symbolCapacity;
+    Cons **labels;          // Conses defined so far in the current message
+    size_t labelCount;
+    size_t labelCapacity;
+};
+
+/**
+    Writes the stream magic, once at the start of a stream
+ @param fp The file to write to
+ */
+void binaryWriteHeader(FILE *fp);
+
+/**
+    Writes one SExpr as a message
+    Lambdas, builtins and futures cannot be written
+ @param fp The file to write to
+ @param expr The SExpr to write
+ */
+void binaryWrite(FILE *fp, SExpr expr);
+
+/**
+    Initializes a streaming decoder
+ @param reader The reader
+ @param fp The file to read from
+ */
+void binaryReaderInit(BinaryReader *reader, FILE *fp);
+
+/**
+    Frees the storage of a decoder (does not close the file)
+ @param reader The reader
+ */
+void binaryReaderFree(BinaryReader *reader);
+
+/**
+    Reads the next message
+ @param reader The reader
+ @param expr Filled with the decoded SExpr
+ @return 1 if a message was read, 0 at the end of the stream
+ */
+int binaryRead(BinaryReader *reader, SExpr *expr);
+
+/**
+    write-binary builtin, (write-binary x path), writes x to a new binary file
+ @param args The SExpr and the path string
+ @return The path
+ */
+SExpr evalWriteBinary(SExpr args);
+
+/**
+    read-binary builtin, (read-binary path), reads the first SExpr of a binary file
+ @param args The list holding the path string
+ @return The SExpr read, or NIL for an empty stream
+ */
+SExpr evalReadBinary(SExpr args);
+
+#endif /* binary_h */
@@ -0,0 +1,151 @@
+//
+//  buffer.c
+//      Growable byte buffer used to batch output
+//  L1962
+//
+
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "buffer.h"
+#include "try.h"
+
+void bufferInit(Buffer *buffer) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    buffer->file = NULL;
+    buffer->fd = -1;
+}
+
+void bufferFree(Buffer *buffer) {
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+/**
+    Makes room for n more bytes plus a NUL (private)
+ @param buffer The buffer
+ @param n The number of bytes needed
+ */
+static void bufferReserve(Buffer *buffer, size_t n) {
+    if (buffer->length + n + 1 > buffer->capacity) {
+        size_t capacity = (buffer->capacity == 0) ? 256 : buffer->capacity;
+        while (buffer->length + n + 1 > capacity) {
+            capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, capacity);
+        buffer->capacity = capacity;
+    }
+}
+
+void bufferAppend(Buffer *buffer, const char *data, size_t n) {
+    bufferReserve(buffer, n);
+    memcpy(buffer->data + buffer->length, data, n);
+    buffer->length += n;
+    if (buffer->length >= BUFFER_CHUNK) {
+        bufferFlush(buffer);
+    }
+}
+
+void bufferString(Buffer *buffer, const char *s) {
+    bufferAppend(buffer, s, strlen(s));
+}
+
+void bufferChar(Buffer *buffer, char c) {
+    if (buffer->length + 2 > buffer->capacity) {
+        bufferReserve(buffer, 1);
+    }
+    buffer->data[buffer->length++] = c;
+    if (buffer->length >= BUFFER_CHUNK) {
+        bufferFlush(buffer);
+    }
+}
+
+void bufferInt(Buffer *buffer, int64_t value) {
+    char digits[24];
+    int i = sizeof(digits);
+    uint64_t magnitude = (value < 0) ? -(uint64_t) value : (uint64_t) value; // Safe for INT64_MIN
+    do {
+        digits[--i] = '0' + (magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        digits[--i] = '-';
+    }
+    bufferAppend(buffer, digits + i, sizeof(digits) - i);
+}
+
+void bufferReal(Buffer *buffer, double value) {
+    double magnitude = fabs(value);
+    if (!(magnitude < 9007199254740992.0)) { // NaN, infinities and values past 2^53 take the slow path
+        char text[512];
+        int n = snprintf(text, sizeof(text), "%f", value);
+        bufferAppend(buffer, text, (n < (int) sizeof(text)) ? (size_t) n : sizeof(text) - 1);
+        return;
+    }
+    // Integer part and fraction are exact, the fraction is scaled by 10^6 and rounded like printf:
+    // fma recovers the rounding error of the product so halfway cases are decided on the exact value
+    uint64_t whole = (uint64_t) magnitude;
+    double fraction = magnitude - (double) whole;
+    double scaled = fraction * 1e6;
+    double error = fma(fraction, 1e6, -scaled);
+    double floored = floor(scaled);
+    uint64_t micros = (uint64_t) floored;
+    double above = (scaled - floored - 0.5) + error; // Sign is exact: rounded sums are only 0 when exact
+    if (above > 0 || (above == 0 && (micros & 1))) {
+        micros++;
+    }
+    if (micros >= 1000000) {
+        micros -= 1000000;
+        whole++;
+    }
+    if (signbit(value)) {
+        bufferChar(buffer, '-');
+    }
+    bufferInt(buffer, (int64_t) whole);
+    char digits[7];
+    digits[0] = '.';
+    for (int i = 6; i > 0; i--) {
+        digits[i] = '0' + (micros % 10);
+        micros /= 10;
+    }
+    bufferAppend(buffer, digits, sizeof(digits));
+}
+
+const char *bufferCString(Buffer *buffer) {
+    bufferReserve(buffer, 0);
+    buffer->data[buffer->length] = 0;
+    return buffer->data;
+}
+
+void bufferFlush(Buffer *buffer) {
+    if (buffer->length == 0) {
+        return;
+    }
+    size_t length = buffer->length;
+    buffer->length = 0; // Emptied before a failure, so the same bytes are not reported again
+    if (buffer->file != NULL) {
+        if (fwrite(buffer->data, 1, length, buffer->file) != length) {
+            fail("error writing output: %s", strerror(errno));
+        }
+    } else if (buffer->fd >= 0) {
+        size_t written = 0;
+        while (written < length) {
+            ssize_t n = write(buffer->fd, buffer->data + written, length - written);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                fail("error writing output: %s", (n < 0) ? strerror(errno) : "nothing written");
+            }
+            written += (size_t) n;
+        }
+    } else {
+        buffer->length = length; // No sink, keep accumulating
+    }
+}
@@ -0,0 +1,91 @@
+//
+//  buffer.h
+//      Growable byte buffer used to batch output
+//  L1962
+//
+
+#ifndef buffer_h
+#define buffer_h
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BUFFER_CHUNK 65536 // Buffers with a sink flush once they hold this much
+
+/**
+    Buffer Struct, bytes waiting to be written
+    With a sink (file or fd) it flushes itself in BUFFER_CHUNK sized writes, without one it just grows
+ */
+typedef struct Buffer Buffer;
+struct Buffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+    FILE *file; // Sink when not NULL
+    int fd;     // Sink when not -1
+};
+
+/**
+    Initializes an empty buffer without a sink
+ @param buffer The buffer
+ */
+void bufferInit(Buffer *buffer);
+
+/**
+    Frees the storage of a buffer
+ @param buffer The buffer
+ */
+void bufferFree(Buffer *buffer);
+
+/**
+    Appends bytes
+ @param buffer The buffer
+ @param data The bytes
+ @param n The number of bytes
+ */
+void bufferAppend(Buffer *buffer, const char *data, size_t n);
+
+/**
+    Appends a NUL terminated string (without the NUL)
+ @param buffer The buffer
+ @param s The string
+ */
+void bufferString(Buffer *buffer, const char *s);
+
+/**
+    Appends one byte
+ @param buffer The buffer
+ @param c The byte
+ */
+void bufferChar(Buffer *buffer, char c);
+
+/**
+    Appends an integer in decimal
+ @param buffer The buffer
+ @param value The integer
+ */
+void bufferInt(Buffer *buffer, int64_t value);
+
+/**
+    Appends a real exactly as printf("%f") would
+ @param buffer The buffer
+ @param value The real
+ */
+void bufferReal(Buffer *buffer, double value);
+
+/**
+    Makes the contents a NUL terminated string (the NUL is not counted in length)
+ @param buffer The buffer
+ @return The contents
+ */
+const char *bufferCString(Buffer *buffer);
+
+/**
+    Writes the contents to the sink, if there is one, and empties the buffer
+    Interrupted writes are retried, any other write error fails after the buffer is emptied
+ @param buffer The buffer
+ */
+void bufferFlush(Buffer *buffer);
+
+#endif /* buffer_h */
@@ -0,0 +1,137 @@
+//
+//  bytevectors.c
+//      Bytevectors, raw bytes with an O(1) length, and their conversions to and from strings
+//  L1962
+//
+
+#include <string.h>
+
+#include "bytevectors.h"
+
+/**
+    Checks that an SExpr is a byte (private)
+ @param expr The SExpr
+ @return The byte
+ */
+static uint8_t checkByte(SExpr expr) {
+    if (expr.type != INT || expr.i < 0 || expr.i > 255) {
+        fail("Expected a byte from 0 to 255");
+    }
+    return (uint8_t) expr.i;
+}
+
+/**
+    Checks an index into a bytevector or string (private)
+ @param expr The bytevector or string
+ @param index The index
+ @return The index
+ */
+static size_t checkIndex(SExpr expr, SExpr index) {
+    if (index.type != INT || index.i < 0 || (uint64_t) index.i >= stringLength(expr)) {
+        fail("Bytevector index out of range");
+    }
+    return (size_t) index.i;
+}
+
+/**
+    The optional [start [end]] range after the first argument, the whole thing by default (private)
+ @param argc The number of arguments, 1 to 3
+ @param argv The bytevector or string and the range
+ @param start Set to the start
+ @param end Set to the end
+ */
+static void optionalRange(int argc, SExpr *argv, size_t *start, size_t *end) {
+    check(argc >= 1 && argc <= 3);
+    size_t length = stringLength(argv[0]);
+    *start = 0;
+    *end = length;
+    if (argc >= 2) {
+        check(argv[1].type == INT && argv[1].i >= 0);
+        *start = (size_t) argv[1].i;
+    }
+    if (argc == 3) {
+        check(argv[2].type == INT && argv[2].i >= 0);
+        *end = (size_t) argv[2].i;
+    }
+    if (*start > *end || *end > length) {
+        fail("Range %zu to %zu out of bounds for length %zu", *start, *end, length);
+    }
+}
+
+SExpr evalBytevector(int argc, SExpr *argv) {
+    SExpr bytevector = bytevectorToSExpr(NULL, (size_t) argc);
+    for (int i = 0; i < argc; i++) {
+        bytevector.bytes[i] = checkByte(argv[i]);
+    }
+    return bytevector;
+}
+
+SExpr evalMakeBytevector(int argc, SExpr *argv) {
+    check(argc == 1 || argc == 2);
+    check(argv[0].type == INT && argv[0].i >= 0);
+    SExpr bytevector = bytevectorToSExpr(NULL, (size_t) argv[0].i);
+    if (argc == 2) {
+        memset(bytevector.bytes, checkByte(argv[1]), (size_t) argv[0].i);
+    }
+    return bytevector;
+}
+
+SExpr evalIsBytevector(int argc, SExpr *argv) {
+    check(argc == 1);
+    return (argv[0].type == BYTEVECTOR) ? TObj : NILObj;
+}
+
+SExpr evalBytevectorLength(int argc, SExpr *argv) {
+    check(argc == 1);
+    check(argv[0].type == BYTEVECTOR);
+    return intToSExpr((int64_t) stringLength(argv[0]));
+}
+
+SExpr evalBytevectorRef(int argc, SExpr *argv) {
+    check(argc == 2);
+    check(argv[0].type == BYTEVECTOR);
+    return intToSExpr(argv[0].bytes[checkIndex(argv[0], argv[1])]);
+}
+
+SExpr evalBytevectorSet(int argc, SExpr *argv) {
+    check(argc == 3);
+    check(argv[0].type == BYTEVECTOR);
+    argv[0].bytes[checkIndex(argv[0], argv[1])] = checkByte(argv[2]);
+    return NILObj;
+}
+
+SExpr evalBytevectorCopy(int argc, SExpr *argv) {
+    check(argc >= 1 && argv[0].type == BYTEVECTOR);
+    size_t start, end;
+    optionalRange(argc, argv, &start, &end);
+    return bytevectorToSExpr(argv[0].bytes + start, end - start);
+}
+
+SExpr evalBytevectorAppend(int argc, SExpr *argv) {
+    size_t length = 0;
+    for (int i = 0; i < argc; i++) {
+        check(argv[i].type == BYTEVECTOR);
+        length += stringLength(argv[i]);
+    }
+    SExpr bytevector = bytevectorToSExpr(NULL, length);
+    size_t offset = 0;
+    for (int i = 0; i < argc; i++) {
+        memcpy(bytevector.bytes + offset, argv[i].bytes, stringLength(argv[i]));
+        offset += stringLength(argv[i]);
+    }
+    return bytevector;
+}
+
+SExpr evalUtf8ToString(int argc, SExpr *argv) {
+    check(argc >= 1 && argv[0].type == BYTEVECTOR);
+    size_t start, end;
+    optionalRange(argc, argv, &start, &end);
+    return stringToSExprLength((const char *) argv[0].bytes + start, end - start);
+}
+
+SExpr evalStringToUtf8(int argc, SExpr *argv) {
+    check(argc >= 1 && argv[0].type == STRING);
+    size_t start, end;
+    optionalRange(argc, argv, &start, &end);
+    return bytevectorToSExpr((const uint8_t *) argv[0].string + start, end - start);
+}
@@ -0,0 +1,92 @@
+//
+//  bytevectors.h
+//      Bytevectors, raw bytes with an O(1) length, and their conversions to and from strings
+//  L1962
+//
+
+#ifndef bytevectors_h
+#define bytevectors_h
+
+#include "SExpr.h"
+
+/**
+    bytevector builtin, (bytevector bytes...)
+ @param argc The number of bytes
+ @param argv The bytes, INTs from 0 to 255
+ @return The bytevector
+ */
+SExpr evalBytevector(int argc, SExpr *argv);
+
+/**
+    make-bytevector builtin, (make-bytevector length [fill])
+ @param argc The number of arguments, 1 or 2
+ @param argv The length and the optional fill byte, 0 by default
+ @return The bytevector
+ */
+SExpr evalMakeBytevector(int argc, SExpr *argv);
+
+/**
+    bytevector? builtin, (bytevector? value)
+ @param argc The number of arguments, 1
+ @param argv The value
+ @return true if it is a bytevector
+ */
+SExpr evalIsBytevector(int argc, SExpr *argv);
+
+/**
+    bytevector-length builtin, (bytevector-length bytevector)
+ @param argc The number of arguments, 1
+ @param argv The bytevector
+ @return The number of bytes as an INT
+ */
+SExpr evalBytevectorLength(int argc, SExpr *argv);
+
+/**
+    bytevector-u8-ref builtin, (bytevector-u8-ref bytevector index)
+ @param argc The number of arguments, 2
+ @param argv The bytevector and the zero based index
+ @return The byte as an INT
+ */
+SExpr evalBytevectorRef(int argc, SExpr *argv);
+
+/**
+    bytevector-u8-set! builtin, (bytevector-u8-set! bytevector index byte)
+ @param argc The number of arguments, 3
+ @param argv The bytevector, the zero based index and the byte
+ @return NIL
+ */
+SExpr evalBytevectorSet(int argc, SExpr *argv);
+
+/**
+    bytevector-copy builtin, (bytevector-copy bytevector [start [end]])
+ @param argc The number of arguments, 1 to 3
+ @param argv The bytevector and the optional range
+ @return A fresh bytevector with the bytes in the range
+ */
+SExpr evalBytevectorCopy(int argc, SExpr *argv);
+
+/**
+    bytevector-append builtin, (bytevector-append bytevectors...)
+ @param argc The number of bytevectors
+ @param argv The bytevectors
+ @return A fresh bytevector with all of their bytes
+ */
+SExpr evalBytevectorAppend(int argc, SExpr *argv);
+
+/**
+    utf8->string builtin, (utf8->string bytevector [start [end]]), the bytes are copied as they are
+ @param argc The number of arguments, 1 to 3
+ @param argv The bytevector and the optional range
+ @return The string
+ */
+SExpr evalUtf8ToString(int argc, SExpr *argv);
+
+/**
+    string->utf8 builtin, (string->utf8 string [start [end]]), strings already hold their UTF-8 bytes
+ @param argc The number of arguments, 1 to 3
+ @param argv The string and the optional byte range
+ @return The bytevector
+ */
+SExpr evalStringToUtf8(int argc, SExpr *argv);
+
+#endif /* bytevectors_h */
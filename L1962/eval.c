@@ -6,11 +6,27 @@
 //
 
 #include <stdio.h>
+#include <pthread.h>
+#include <stdatomic.h>
 
 #include "eval.h"
+#include "image.h"
+#include "parallel.h"
+#include "binary.h"
+#include "port.h"
+#include "analyze.h"
+#include "lists.h"
+#include "records.h"
+#include "vectors.h"
+#include "bytevectors.h"
+#include "stringSearch.h"
 
 DEFINE_WRAPPER_1(car);
 DEFINE_WRAPPER_1(cdr);
+DEFINE_WRAPPER_1(caar);
+DEFINE_WRAPPER_1(cadr);
+DEFINE_WRAPPER_1(cdar);
+DEFINE_WRAPPER_1(cddr);
 
 DEFINE_WRAPPER_1(not);
 DEFINE_WRAPPER_1(cons);
@@ -20,6 +36,7 @@ DEFINE_WRAPPER_1(str);
 DEFINE_WRAPPER_1(strup);
 DEFINE_WRAPPER_1(strlow);
 DEFINE_WRAPPER_1(stringToList);
+DEFINE_WRAPPER_1(sexprToString);
 
 DEFINE_WRAPPER_1(Char);
 DEFINE_WRAPPER_1(charToInt);
@@ -29,10 +46,14 @@ DEFINE_WRAPPER_1(charlow);
 
 DEFINE_WRAPPER_2(consToSExpr);
 DEFINE_WRAPPER_2(assoc);
+DEFINE_WRAPPER_2(assq);
+DEFINE_WRAPPER_2(assv);
 DEFINE_WRAPPER_2(setcar);
 DEFINE_WRAPPER_2(setcdr);
 
 DEFINE_WRAPPER_2(eq);
+DEFINE_WRAPPER_2(eqp);
+DEFINE_WRAPPER_2(eqvp);
 DEFINE_WRAPPER_2(greater);
 DEFINE_WRAPPER_2(greaterEQ);
 DEFINE_WRAPPER_2(less);
@@ -40,7 +61,56 @@ DEFINE_WRAPPER_2(lessEQ);
 
 DEFINE_WRAPPER_3(acons);
 
-SExpr global = { NIL }; //The global environment
+DEFINE_WRAPPER_ARGS(env);
+DEFINE_WRAPPER_ARGS(evalSaveImage);
+DEFINE_WRAPPER_ARGS(evalWriteBinary);
+DEFINE_WRAPPER_ARGS(evalReadBinary);
+DEFINE_WRAPPER_ARGS(evalPMap);
+DEFINE_WRAPPER_ARGS(evalPForEach);
+DEFINE_WRAPPER_ARGS(evalPReduce);
+DEFINE_WRAPPER_ARGS(evalSetParallelWorkers);
+DEFINE_WRAPPER_ARGS(evalSetParallelChunkSize);
+DEFINE_WRAPPER_ARGS(evalTouch);
+DEFINE_WRAPPER_ARGS(evalIsFuture);
+DEFINE_WRAPPER_ARGS(evalOpenInputFile);
+DEFINE_WRAPPER_ARGS(evalOpenOutputFile);
+DEFINE_WRAPPER_ARGS(evalOpenInputFd);
+DEFINE_WRAPPER_ARGS(evalOpenOutputFd);
+DEFINE_WRAPPER_ARGS(evalOpenInputString);
+DEFINE_WRAPPER_ARGS(evalOpenOutputString);
+DEFINE_WRAPPER_ARGS(evalGetOutputString);
+DEFINE_WRAPPER_ARGS(evalClosePort);
+DEFINE_WRAPPER_ARGS(evalCurrentOutputPort);
+DEFINE_WRAPPER_ARGS(evalRead);
+DEFINE_WRAPPER_ARGS(evalReadLine);
+DEFINE_WRAPPER_ARGS(evalReadChar);
+DEFINE_WRAPPER_ARGS(evalWrite);
+DEFINE_WRAPPER_ARGS(evalDisplay);
+DEFINE_WRAPPER_ARGS(evalNewline);
+DEFINE_WRAPPER_ARGS(evalWithOutputToString);
+DEFINE_WRAPPER_ARGS(evalIsEOFObject);
+DEFINE_WRAPPER_ARGS(evalIsPort);
+DEFINE_WRAPPER_ARGS(evalAppend);
+DEFINE_WRAPPER_ARGS(evalSubstring);
+DEFINE_WRAPPER_ARGS(evalListToString);
+
+_Thread_local SExpr global = { NIL }; //The global environment
+_Thread_local uint64_t globalEpoch = 0;
+
+static atomic_uint_fast64_t epochCounter = 0; // Epochs are unique across threads, so a pool worker can adopt its caller's
+static atomic_uint_fast64_t pureOverwrites = 0; // Folded calls are valid until a pure builtin is overwritten in any thread's global
+
+static SExpr (*const pureBuiltins[])(int argc, SExpr *argv) = { // Same result for the same arguments and no side effects
+    addSExpr, subtractSExpr, multiplySExpr, divideSExpr,
+    apply_eq, apply_eqp, apply_eqvp, apply_greater, apply_greaterEQ, apply_less, apply_lessEQ,
+    apply_not, apply_cons, apply_str, apply_Char,
+    evalMax, evalMin,
+    apply_strlength, apply_charToInt, apply_intToChar, apply_charup, apply_charlow,
+};
+
+
+static SExpr builtins = { NIL }; // a-list of every registered builtin by name, used by images, shared by all threads
+static pthread_mutex_t builtinsLock = PTHREAD_MUTEX_INITIALIZER;
 
 void evalInit(void) {
     global = acons(makeSymbol("nil"), NILObj, global);
@@ -49,18 +119,119 @@ void evalInit(void) {
     
     addBuiltin("car", apply_car);
     addBuiltin("cdr", apply_cdr);
+    addBuiltin("caar", apply_caar);
+    addBuiltin("cadr", apply_cadr);
+    addBuiltin("cdar", apply_cdar);
+    addBuiltin("cddr", apply_cddr);
     addBuiltin("cons", apply_consToSExpr);
     addBuiltin("set-car!", apply_setcar);
     addBuiltin("set-cdr!", apply_setcdr);
     addBuiltin("assoc", apply_assoc);
+    addBuiltin("assq", apply_assq);
+    addBuiltin("assv", apply_assv);
     addBuiltin("acons", apply_acons);
-    addBuiltin("env", env);
+    addBuiltin("env", apply_env);
+    addBuiltin("save-image", apply_evalSaveImage);
+    addBuiltin("write-binary", apply_evalWriteBinary);
+    addBuiltin("read-binary", apply_evalReadBinary);
+    
+    addBuiltin("pmap", apply_evalPMap);
+    addBuiltin("pfor-each", apply_evalPForEach);
+    addBuiltin("preduce", apply_evalPReduce);
+    addBuiltin("set-parallel-workers!", apply_evalSetParallelWorkers);
+    addBuiltin("set-parallel-chunk-size!", apply_evalSetParallelChunkSize);
+    addBuiltin("touch", apply_evalTouch);
+    addBuiltin("future?", apply_evalIsFuture);
+    
+    addBuiltin("open-input-file", apply_evalOpenInputFile);
+    addBuiltin("open-output-file", apply_evalOpenOutputFile);
+    addBuiltin("open-input-fd", apply_evalOpenInputFd);
+    addBuiltin("open-output-fd", apply_evalOpenOutputFd);
+    addBuiltin("open-input-string", apply_evalOpenInputString);
+    addBuiltin("open-output-string", apply_evalOpenOutputString);
+    addBuiltin("get-output-string", apply_evalGetOutputString);
+    addBuiltin("close-port", apply_evalClosePort);
+    addBuiltin("current-output-port", apply_evalCurrentOutputPort);
+    addBuiltin("read", apply_evalRead);
+    addBuiltin("read-line", apply_evalReadLine);
+    addBuiltin("read-char", apply_evalReadChar);
+    addBuiltin("write", apply_evalWrite);
+    addBuiltin("display", apply_evalDisplay);
+    addBuiltin("newline", apply_evalNewline);
+    addBuiltin("with-output-to-string", apply_evalWithOutputToString);
+    addBuiltin("eof-object?", apply_evalIsEOFObject);
+    addBuiltin("port?", apply_evalIsPort);
+    
+    addBuiltin("length", evalLength);
+    addBuiltin("list", evalList);
+    addBuiltin("list*", evalListStar);
+    addBuiltin("last", evalLast);
+    addBuiltin("append", evalListAppend);
+    addBuiltin("merge-list", evalListAppend);
+    addBuiltin("reverse", evalReverse);
+    addBuiltin("map", evalMap);
+    addBuiltin("filter", evalFilter);
+    addBuiltin("fold", evalFold);
+    addBuiltin("nth", evalNth);
+    addBuiltin("member", evalMember);
+    addBuiltin("sort", evalSort);
+    
+    addBuiltin("make-record", evalMakeRecord);
+    addBuiltin("record?", evalIsRecord);
+    addBuiltin("record-ref", evalRecordRef);
+    addBuiltin("record-set!", evalRecordSet);
+    
+    addBuiltin("f64vector", evalF64Vector);
+    addBuiltin("s64vector", evalS64Vector);
+    addBuiltin("make-f64vector", evalMakeF64Vector);
+    addBuiltin("make-s64vector", evalMakeS64Vector);
+    addBuiltin("list->f64vector", evalListToF64Vector);
+    addBuiltin("list->s64vector", evalListToS64Vector);
+    addBuiltin("f64vector?", evalIsF64Vector);
+    addBuiltin("s64vector?", evalIsS64Vector);
+    addBuiltin("f64vector->list", evalVectorToList);
+    addBuiltin("s64vector->list", evalVectorToList);
+    addBuiltin("f64vector-length", evalVectorLength);
+    addBuiltin("s64vector-length", evalVectorLength);
+    addBuiltin("f64vector-ref", evalVectorRef);
+    addBuiltin("s64vector-ref", evalVectorRef);
+    addBuiltin("f64vector-set!", evalVectorSet);
+    addBuiltin("s64vector-set!", evalVectorSet);
+    addBuiltin("vector-sum", evalVectorSum);
+    addBuiltin("vector-dot", evalVectorDot);
+    addBuiltin("vector-min", evalVectorMin);
+    addBuiltin("vector-max", evalVectorMax);
+    addBuiltin("vector-add", evalVectorAdd);
+    addBuiltin("vector-mul", evalVectorMul);
+    addBuiltin("vector-scale", evalVectorScale);
+    addBuiltin("vector<", evalVectorLess);
+    addBuiltin("vector<=", evalVectorLessEQ);
+    addBuiltin("vector>", evalVectorGreater);
+    addBuiltin("vector>=", evalVectorGreaterEQ);
+    addBuiltin("vector=", evalVectorEQ);
+    
+    addBuiltin("bytevector", evalBytevector);
+    addBuiltin("make-bytevector", evalMakeBytevector);
+    addBuiltin("bytevector?", evalIsBytevector);
+    addBuiltin("bytevector-length", evalBytevectorLength);
+    addBuiltin("bytevector-u8-ref", evalBytevectorRef);
+    addBuiltin("bytevector-u8-set!", evalBytevectorSet);
+    addBuiltin("bytevector-copy", evalBytevectorCopy);
+    addBuiltin("bytevector-append", evalBytevectorAppend);
+    addBuiltin("utf8->string", evalUtf8ToString);
+    addBuiltin("string->utf8", evalStringToUtf8);
     
     addBuiltin("+", addSExpr);
     addBuiltin("-", subtractSExpr);
     addBuiltin("*", multiplySExpr);
     addBuiltin("/", divideSExpr);
+    addBuiltin("max", evalMax);
+    addBuiltin("min", evalMin);
+    addBuiltin("avg", evalAvg);
     addBuiltin("equal", apply_eq);
+    addBuiltin("equal?", apply_eq);
+    addBuiltin("eq?", apply_eqp);
+    addBuiltin("eqv?", apply_eqvp);
     addBuiltin("=", apply_eq);
     addBuiltin(">", apply_greater);
     addBuiltin(">=", apply_greaterEQ);
@@ -79,10 +250,18 @@ void evalInit(void) {
     addBuiltin("string?", apply_str);
     addBuiltin("string-upcase", apply_strup);
     addBuiltin("string-downcase", apply_strlow);
-    addBuiltin("string-append", evalAppend);
-    addBuiltin("substring", evalSubstring);
-    addBuiltin("list->string", evalListToString);
+    addBuiltin("string-append", apply_evalAppend);
+    addBuiltin("substring", apply_evalSubstring);
+    addBuiltin("list->string", apply_evalListToString);
     addBuiltin("string->list", apply_stringToList);
+    addBuiltin("sexpr->string", apply_sexprToString);
+    addBuiltin("string-index", evalStringIndex);
+    addBuiltin("string-search", evalStringSearch);
+    addBuiltin("string-split", evalStringSplit);
+    addBuiltin("string-join", evalStringJoin);
+    addBuiltin("string-trim", evalStringTrim);
+    addBuiltin("string-trim-left", evalStringTrimLeft);
+    addBuiltin("string-trim-right", evalStringTrimRight);
     
     addBuiltin("char?", apply_Char);
     addBuiltin("char->integer", apply_charToInt);
@@ -92,313 +271,162 @@ void evalInit(void) {
     addBuiltin("char-downcase", apply_charlow);
 }
 
-SExpr eval(SExpr sexpr, SExpr env) {
-    switch (sexpr.type) {
-        case INVALID: // It's an error
-            fail("SExpr Error: of INVALID type");
-        
-        case INT: // Self - Returning
-            return sexpr;
-        
-        case REAL: // Self - Returning
-            return sexpr;
-            
-        case NIL: // Self - Returning
-            return sexpr;
-            
-        case STRING: // Self - Returning
-            return sexpr;
-            
-        case CHAR: // Self - Returning
-            return sexpr;
-            
-        case SYMBOL: // Variable Names
-        {
-            SExpr scopeExisting = assoc(sexpr, env);
-            if (!isNIL(scopeExisting)) {
-                return scopeExisting.cons->cdr;
-            }
-            SExpr globalExisting = assoc(sexpr, global);
-            if (!isNIL(globalExisting)) {
-                return globalExisting.cons->cdr;
-            }
-            fail("No Matching Variable Found in Environment: %s", sexpr.symbol);
-        }
-        
-        case END:
-        {
-            SExpr end;
-            end.type = END;
-            return end;
-        }
-            
-        case CONS: // Functions and things
-        { // Need quote, set!, lambda, env, define, if, and, or (things that happen before the eval step)
-            // Special Forms and Macros
-            const char *sym = car(sexpr).symbol;
-            if (sym == sym_QUOTE) {
-                check(cddr(sexpr).type == NIL);
-                return cadr(sexpr);
-            } else if (sym == sym_BQUOTE) {
-                assert(cddr(sexpr).type == NIL);
-                return lookForCommas(cadr(sexpr), env);
-            } else if (sym == sym_COMMA) {
-                fail("Comma found outside of backquote");
-            } else if (sym == sym_SETBang) {
-                check(cadr(sexpr).type == SYMBOL);
-                return evalSETBang(cadr(sexpr), eval(car(cddr(sexpr)), env), env);
-            } else if (sym == sym_LAMBDA) {
-                return lambdaToSExpr(cadr(sexpr), cddr(sexpr), env);
-            } else if (sym == sym_LET) {
-                return evalLet(cadr(sexpr), cddr(sexpr), env);
-            } else if (sym == sym_DEFINE) {
-                return evalDefine(cadr(sexpr), cddr(sexpr));
-            } else if (sym == sym_DEFUN) {
-                return evalDEFUN(cadr(sexpr), car(cddr(sexpr)), cdr(cddr(sexpr)));
-            } else if (sym == sym_DEFVAR) {
-                return evalDEFVAR(cadr(sexpr), cddr(sexpr));
-            } else if (sym == sym_MACRO) {
-                
-            } else if (sym == sym_IF) {
-                if (cdr(cddr(sexpr)).type == NIL) {
-                    return evalIf(cadr(sexpr), car(cddr(sexpr)), NILObj, env);
-                } else {
-                    return evalIf(cadr(sexpr), car(cddr(sexpr)), cadr(cddr(sexpr)), env);
-                }
-            } else if (sym == sym_COND) {
-                return evalCond(cdr(sexpr), env);
-            } else if (sym == sym_WHEN) {
-                return evalWhen(cadr(sexpr), cddr(sexpr), env);
-            } else if (sym == sym_UNLESS) {
-                return evalUnless(cadr(sexpr), cddr(sexpr), env);
-            } else if (sym == sym_AND) {
-                check(!isNIL(cddr(sexpr)));       // Must be a two+ element list
-                return evalAnd(cdr(sexpr), env);
-            } else if (sym == sym_OR) {
-                check(!isNIL(cddr(sexpr)));       // Must be a two+ element list
-                return evalOr(cdr(sexpr), env);
-            } else if (sym == sym_PROGN || sym == sym_BEGIN) {
-                return evalProgn(cdr(sexpr), env);
-            } else if (sym == sym_APPLY) {
-                return evalApply(cadr(sexpr), cddr(sexpr), env);
-            }
-            
-            
-            // Evaluate the functions
-            SExpr first = eval(car(sexpr), env);
-            
-            // Evaluate all the arguments
-            SExpr args = evalList(cdr(sexpr), env);
-            
-            // Apply functions
-            if (first.type == LAMBDA) {
-                return evalLambda(*first.lambda, args);
-            } else if (first.type == BUILTIN) {
-                return (first.builtin.apply)(args);
-            }
-            
-            
-            if (car(sexpr).type == SYMBOL) {
-                fail("Function %s has no match", sym);
-            } else {
-                fail("Function Name not of Type Symbol: %s", SExprName(car(sexpr).type));
-            }
-                
+/**
+    Draws a new epoch for this thread's global environment (private)
+ */
+static void newEpoch(void) {
+    globalEpoch = atomic_fetch_add(&epochCounter, 1) + 1;
+}
+
+int isPureBuiltin(SExpr function) {
+    if (function.type != BUILTIN) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(pureBuiltins) / sizeof(pureBuiltins[0]); i++) {
+        if (function.builtin.apply == pureBuiltins[i]) {
+            return 1;
         }
-            
-        default:
-            fail("Default Error, Not of Valid SExpr Type");
     }
+    return 0;
 }
 
-SExpr evalList(SExpr c, SExpr env) {
-    if (c.type == NIL) {
-        return c;
-    } else {
-        check(isLIST(cdr(c)));
-        return consToSExpr(eval(car(c), env), evalList(cdr(c), env));
-    }
+uint64_t pureVersion(void) {
+    return atomic_load_explicit(&pureOverwrites, memory_order_acquire);
 }
 
-SExpr lookForCommas(SExpr expr, SExpr env) {
-    if (isCONS(expr)) {
-        if (car(expr).symbol == sym_COMMA) { // If comma
-            return eval(cadr(expr), env);
-        } else {
-            return consToSExpr(lookForCommas(car(expr), env), lookForCommas(cdr(expr), env));
-        }
-    } else {
-        return expr;
+void setGlobalCell(SExpr cell, SExpr value) {
+    if (isPureBuiltin(uncheckedCdr(cell))) {
+        atomic_fetch_add(&pureOverwrites, 1);
     }
+    cell.cons->cdr = value;
 }
 
-void addBuiltin(const char *name, SExpr (*apply)(SExpr args)) {
-    SExpr key = makeSymbol(name);
-    global = acons(key, makeBuiltin(apply), global);
+void setGlobal(SExpr env) {
+    global = env;
+    newEpoch();
 }
 
-SExpr evalSETBang(SExpr name, SExpr value, SExpr env) {
-    check(isSYMBOL(name));
-    check(name.symbol != NULL);
-    SExpr scopeExisting = assoc(name, env);
-    if (!isNIL(scopeExisting)) {
-        scopeExisting.cons->cdr = value;
-        return name;
-    }
-    SExpr globalExisting = assoc(name, global);
-    if (!isNIL(globalExisting)) {
-        globalExisting.cons->cdr = value;
-    } else {
-        global = acons(name, value, global);
-    }
-    return name;
+SExpr eval(SExpr sexpr, SExpr env) {
+    return runNode(analyze(sexpr, scopeOf(env)), env);
 }
 
-SExpr evalLambda(Lambda lambda, SExpr args) {
-    SExpr param;
-    SExpr arg;
-    for (param = lambda.params, arg = args; param.type == CONS; param = cdr(param), arg = cdr(arg)) {
-        lambda.env = acons(car(param), car(arg), lambda.env);
+SExpr applyFunction(SExpr function, SExpr args) {
+    size_t argc = 0;
+    for (SExpr current = args; isCONS(current); current = uncheckedCdr(current)) {
+        argc++;
     }
-    if (param.type == NIL) {
-        check(arg.type == NIL);
-    } else if (param.type == SYMBOL) {
-        lambda.env = acons(param, arg, lambda.env);
-    } else {
-        fail("Illegal type at end of lambda parameter list: %s", SExprName(param.type));
+    SExpr stack[(argc > 0 && argc <= ARGS_ON_STACK) ? argc : 1];
+    SExpr *argv = (argc <= ARGS_ON_STACK) ? stack : malloc(argc * sizeof(SExpr));
+    size_t i = 0;
+    for (SExpr current = args; isCONS(current); current = uncheckedCdr(current)) {
+        argv[i++] = uncheckedCar(current);
     }
-    SExpr result = NILObj;
-    for (SExpr expr = lambda.exprs; expr.type != NIL; expr = cdr(expr)) {
-        result = eval(car(expr), lambda.env);
+    SExpr result = callFunction(function, (int) argc, argv);
+    if (argv != stack) {
+        free(argv);
     }
     return result;
 }
 
-SExpr evalDefine(SExpr id, SExpr expr) {
-    if (isSYMBOL(id)) {
-        return evalSETBang(id, eval(car(expr), NILObj), global);
-    } else if (isCONS(id)) {
-        SExpr name = car(id);
-        SExpr params = cdr(id);
-        return evalSETBang(name, lambdaToSExpr(params, expr, NILObj), global);
-    } else {
-        fail("Invalid define: id is not of type SYMBOL or type CONS");
-    }
-}
-
-SExpr evalDEFUN(SExpr name, SExpr params, SExpr expr) {
-    return evalSETBang(name, lambdaToSExpr(params, expr, NILObj), global);
-}
-
-SExpr evalDEFVAR(SExpr name, SExpr expr) {
-    if(isNIL(expr)) { // Initialize variable
-        return evalSETBang(name, NILObj, global);
-    } else {
-        return evalSETBang(name, eval(car(expr), NILObj), global);
+SExpr callFunction(SExpr function, int argc, SExpr *argv) {
+    if (function.type == LAMBDA) {
+        return evalLambda(function.lambda, argc, argv);
+    } else if (function.type == BUILTIN) {
+        return (function.builtin.apply)(argc, argv);
     }
+    fail("Cannot apply an SExpr of type %s", SExprName(function.type));
 }
 
-SExpr env(SExpr args) {
-    check(args.type == NIL);
-    return global;
-}
-
-SExpr evalIf(SExpr condition, SExpr ifTrue, SExpr ifFalse, SExpr env) {
-    SExpr evaled = eval(condition, env);
-    if(!isNIL(evaled)) {
-        return eval(ifTrue, env);
-    } else {
-        return eval(ifFalse, env);
+void addBuiltin(const char *name, SExpr (*apply)(int argc, SExpr *argv)) {
+    SExpr key = makeSymbol(name);
+    SExpr builtin = makeBuiltin(apply);
+    pthread_mutex_lock(&builtinsLock);
+    if (isNIL(assq(key, builtins))) {
+        builtins = acons(key, builtin, builtins);
     }
+    pthread_mutex_unlock(&builtinsLock);
+    global = acons(key, builtin, global);
 }
 
-SExpr evalCond(SExpr exprs, SExpr env) {
-    SExpr result = NILObj;
-    SExpr current;
-    for (current = exprs; isNIL(eval(car(car(current)), env)); current = cdr(current)) { // Repeat until a statement is true
-        if (isNIL(cdr(current))) {
-            current = consToSExpr(NILObj, NILObj); // fills out the current buffer, needs a car and a cdr
-            break;
+const char *builtinName(SExpr builtin) {
+    check(builtin.type == BUILTIN);
+    pthread_mutex_lock(&builtinsLock);
+    SExpr table = builtins;
+    pthread_mutex_unlock(&builtinsLock);
+    for (SExpr current = table; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr pair = uncheckedCar(current);
+        if (uncheckedCdr(pair).builtin.apply == builtin.builtin.apply) {
+            return uncheckedCar(pair).symbol;
         }
     }
-    for (current = car(current); !isNIL(current); current = cdr(current)) {
-        result = eval(car(current), env);
-    }
-    return result;
+    return NULL;
 }
 
-SExpr evalWhen(SExpr condition, SExpr exprs, SExpr env) {
-    SExpr evaled = eval(condition, env);
-    if (!isNIL(evaled)) {
-        SExpr result = NILObj;
-        for (SExpr current = exprs; !isNIL(current); current = cdr(current)) {
-            result = eval(car(current), env);
-        }
-        return result;
-    } else {
+SExpr findBuiltin(const char *name) {
+    pthread_mutex_lock(&builtinsLock);
+    SExpr table = builtins;
+    pthread_mutex_unlock(&builtinsLock);
+    SExpr existing = assq(symbolToSExpr(name), table);
+    if (isNIL(existing)) {
         return NILObj;
     }
+    return uncheckedCdr(existing);
 }
 
-SExpr evalUnless(SExpr condition, SExpr exprs, SExpr env) {
-    SExpr evaled = eval(condition, env);
-    if (isNIL(evaled)) {
-        SExpr result = NILObj;
-        for (SExpr current = exprs; !isNIL(current); current = cdr(current)) {
-            result = eval(car(current), env);
+SExpr copyEnvironment(SExpr env) {
+    SExpr copy = NILObj;
+    SExpr last = NILObj;
+    for (SExpr current = env; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr pair = uncheckedCar(current);
+        check(isCONS(pair));
+        SExpr cell = consToSExpr(consToSExpr(uncheckedCar(pair), uncheckedCdr(pair)), NILObj); // Fresh binding, same value
+        if (isNIL(last)) {
+            copy = cell;
+        } else {
+            last.cons->cdr = cell;
         }
-        return result;
-    } else {
-        return NILObj;
+        last = cell;
     }
+    return copy;
 }
 
-SExpr evalAnd(SExpr args, SExpr env) {
-    // does this have a required number of initial terms
-    if (args.type == NIL) {
-        return TObj;
+SExpr evalSETBang(SExpr name, SExpr value, SExpr env) {
+    check(isSYMBOL(name));
+    check(name.symbol != NULL);
+    SExpr scopeExisting = assq(name, env);
+    if (!isNIL(scopeExisting)) {
+        scopeExisting.cons->cdr = value;
+        return name;
     }
-    if (isNIL(eval(car(args), env))) {
-        return NILObj;
+    SExpr globalExisting = assq(name, global);
+    if (!isNIL(globalExisting)) {
+        setGlobalCell(globalExisting, value); // Cached cells stay valid
     } else {
-        return evalAnd(cdr(args), env);
+        global = acons(name, value, global);
+        newEpoch();
     }
-    
+    return name;
 }
 
-SExpr evalOr(SExpr args, SExpr env) {
-    // does this have a required number of initial terms
-    if (args.type == NIL) {
-        return NILObj;
+SExpr evalLambda(Lambda *lambda, int argc, SExpr *argv) {
+    SExpr env = lambda->env;
+    SExpr param;
+    int i = 0;
+    for (param = lambda->params; param.type == CONS; param = uncheckedCdr(param), i++) {
+        check(i < argc);
+        env = acons(uncheckedCar(param), argv[i], env);
     }
-    if (isNIL(eval(car(args), env))) {
-        return evalOr(cdr(args), env);
+    if (param.type == NIL) {
+        check(i == argc);
+    } else if (param.type == SYMBOL) {
+        env = acons(param, arrayToList(argc - i, argv + i), env);
     } else {
-        return TObj;
-    }
-}
-
-SExpr evalLet(SExpr pairs, SExpr expr, SExpr env) {
-    SExpr params = NILObj;
-    SExpr args = NILObj;
-    for (SExpr current = pairs; !isNIL(current); current = cdr(current)) {
-        params = consToSExpr(caar(current), params);
-        args = consToSExpr(car(cdar(current)), args);
-    }
-    Lambda *lambda = makeLambda(params, expr, env);
-    return evalLambda(*lambda, args);
-}
-
-SExpr evalProgn(SExpr exprs, SExpr env) {
-    SExpr result = NILObj;
-    for (SExpr current = exprs; !isNIL(current); current = cdr(current)) {
-        result = eval(car(current), env);
+        fail("Illegal type at end of lambda parameter list: %s", SExprName(param.type));
     }
-    return result;
+    return runNode(lambdaCode(lambda), env);
 }
 
-SExpr evalApply(SExpr func, SExpr args, SExpr env) {
-    args = eval(consToSExpr(makeSymbol("list*"), args), env);
-    SExpr applied = consToSExpr(func, args);
-    return eval(applied, env);
+SExpr env(SExpr args) {
+    check(args.type == NIL);
+    return global;
 }
@@ -11,194 +11,145 @@
 #include "SExpr.h"
 
 #define DEFINE_WRAPPER_1(name) \
-    SExpr apply_ ## name(SExpr args) { \
-        check(isNIL(cdr(args))); \
-        return name(car(args)); \
+    SExpr apply_ ## name(int argc, SExpr *argv) { \
+        check(argc == 1); \
+        return name(argv[0]); \
     }
-// check that args is a list of exactly one element
+// check that there is exactly one argument
 
 #define DEFINE_WRAPPER_2(name) \
-    SExpr apply_ ## name(SExpr args) { \
-        check(isNIL(cddr(args))); \
-        return name(car(args), cadr(args)); \
+    SExpr apply_ ## name(int argc, SExpr *argv) { \
+        check(argc == 2); \
+        return name(argv[0], argv[1]); \
     }
-// check that args is a list of exactly two elements
+// check that there are exactly two arguments
 
 #define DEFINE_WRAPPER_3(name) \
-    SExpr apply_ ## name(SExpr args) { \
-        check(isNIL(cdr(cddr(args)))); \
-        return name(car(args), cadr(args), car(cddr(args))); \
+    SExpr apply_ ## name(int argc, SExpr *argv) { \
+        check(argc == 3); \
+        return name(argv[0], argv[1], argv[2]); \
     }
-// check that args is a list of exactly three elements
+// check that there are exactly three arguments
 
 #define DEFINE_WRAPPER_ARGS(name) \
-    SExpr apply_ ## name(SExpr args) { \
-        return name(args); \
+    SExpr apply_ ## name(int argc, SExpr *argv) { \
+        return name(arrayToList(argc, argv)); \
     }
-// Builtins that take all of args
+// Builtins that take all of args as a list
 
-/**
-    Initializes the global environment (global)
- */
-void evalInit(void);
-
-/**
-    Evaluates the given SExpr as if it were Lisp code
- @param sexpr The SExpr to eval
- @param env The environment to eval to (for local variables), scope
- @return The results of the evaluation
- */
-SExpr eval(SExpr sexpr, SExpr env);
-
-/**
-    Evaluates the list
- @param c The list to eval
- @param env The environment to eval to (for local variables), scope
- @return The results of the evaluation
- */
-SExpr evalList(SExpr c, SExpr env);
+#define ARGS_ON_STACK 16 // Calls with up to this many arguments keep them in an array on the C stack
 
-/**
-    Makes the builtin and attaches it to the environment
- @param name The name of the builtin, resolves the need for sym_* for each builtin
- @param apply The function to apply
- */
-void addBuiltin(const char *name, SExpr (*apply)(SExpr args));
+extern _Thread_local SExpr global; // The global environment, each thread runs its own evaluator
+extern _Thread_local uint64_t globalEpoch; // Version of global, call sites cache bindings found under it
 
 /**
-    Loops over the given SExpr and looks for commas and evals
- @param expr The SExpr to eval the commas in
- @param env The environment to eval to (for local variables), scope
- @return The SExpr with all the commas evaled
+    Replaces this thread's global environment and draws a new epoch so cached bindings from the old one are not used
+ @param env The new global environment
  */
-SExpr lookForCommas(SExpr expr, SExpr env);
+void setGlobal(SExpr env);
 
 /**
-    set! special form eval (assigns variables in the environmet)
- @param name The name for the variable
- @param value The value to assign to the variable, already evaluated
- @param env  The local scope
- @return NIL for now
+    Checks if a function is one of the builtins whose calls on constants can be folded during analysis
+ @param function The function
+ @return 1 if it is a pure builtin
  */
-SExpr evalSETBang(SExpr name, SExpr value, SExpr env);
+int isPureBuiltin(SExpr function);
 
 /**
-    lambda special form eval
- @param lambda  The lambda
- @param args  List of arguments
- @return The result as an SExpr
+    The number of times a pure builtin has been overwritten in any global environment, folded calls check it has not changed
+ @return The version
  */
-SExpr evalLambda(Lambda lambda, SExpr args);
+uint64_t pureVersion(void);
 
 /**
-    define special form eval (Scheme-sytle)
- @param id  Either variable or function name and parameters
- @param expr The expression
- @return The name of the variable/function
+    Writes the value of a global binding, bumping pureVersion if it held a pure builtin
+ @param cell The (name . value) cell
+ @param value The new value
  */
-SExpr evalDefine(SExpr id, SExpr expr);
+void setGlobalCell(SExpr cell, SExpr value);
 
 /**
-    defun special form eval (Common Lisp-style, (define function))
- @param name  Variable name
- @param params List of parameters
- @param expr The expression for the function
- @return The name of the function
+    Initializes the global environment (global)
  */
-SExpr evalDEFUN(SExpr name, SExpr params, SExpr expr);
+void evalInit(void);
 
 /**
-    defcar special form eval (Common Lisp-style, (define varaivle))
- @param name  Variable name
- @param expr The expression for the varaible
- @return The name of the variable
+    Copies the spine and the bindings of an environment so it can be handed to another evaluator (thread)
+    set! and define in the copy do not affect the original, the bound values themselves are shared
+ @param env The environment to copy
+ @return The copy
  */
-SExpr evalDEFVAR(SExpr name, SExpr expr);
+SExpr copyEnvironment(SExpr env);
 
 /**
-    Wrapper for env
- @param args The arguments, needs to be NIL
- @return The result of env
- */
-SExpr env(SExpr args);
-
-/**
-    If special form eval
- @param condition The condition
- @param ifTrue Eval if true
- @param ifFalse Eval if false
- @param env The environemnt to eval to
- @return The result of the eval
+    Evaluates the given SExpr as if it were Lisp code, analyzing it first (see analyze.h)
+ @param sexpr The SExpr to eval
+ @param env The environment to eval to (for local variables), scope
+ @return The results of the evaluation
  */
-SExpr evalIf(SExpr condition, SExpr ifTrue, SExpr ifFalse, SExpr env);
+SExpr eval(SExpr sexpr, SExpr env);
 
 /**
-    cond special form eval
- @param exprs List of Expressions to eval, car of each expression is the conditional, then eval the rest
- @param env The environemnt to eval to
- @return The result of the last of the evals
+    Applies a function (lambda or builtin) to already evaluated arguments
+ @param function The function to apply
+ @param args The list of evaluated arguments
+ @return The result of the call
  */
-SExpr evalCond(SExpr exprs, SExpr env);
+SExpr applyFunction(SExpr function, SExpr args);
 
 /**
-    when special form eval
- @param condition The condition
- @param exprs The expressions to eval
- @param env The environemnt to eval to
- @return The result of the last of the evals
+    Calls a function (lambda or builtin) with already evaluated arguments in an array
+ @param function The function to call
+ @param argc The number of arguments
+ @param argv The arguments, only borrowed for the call
+ @return The result of the call
  */
-SExpr evalWhen(SExpr condition, SExpr exprs, SExpr env);
+SExpr callFunction(SExpr function, int argc, SExpr *argv);
 
 /**
-    unless special form eval
- @param condition The condition
- @param exprs The expressions to eval
- @param env The environemnt to eval to
- @return The result of the last of the evals
+    Makes the builtin and attaches it to the environment
+ @param name The name of the builtin, resolves the need for sym_* for each builtin
+ @param apply The function to apply
  */
-SExpr evalUnless(SExpr condition, SExpr exprs, SExpr env);
-
+void addBuiltin(const char *name, SExpr (*apply)(int argc, SExpr *argv));
 
 /**
-    and macro
- @param args The list of arguments to eval (must be two or more)
- @param env The environemnt to eval to
- @return True if all arguments are true
+    Finds the name a builtin was registered under (independent of later redefinitions in global)
+ @param builtin The builtin SExpr
+ @return The struniq'ed name or NULL if it was never registered
  */
-SExpr evalAnd(SExpr args, SExpr env);
+const char *builtinName(SExpr builtin);
 
 /**
-    or marco
- @param args The list of arguments to eval (must be two or more)
- @param env The environemnt to eval to
- @return True if one argument is true
+    Finds a registered builtin by name
+ @param name The struniq'ed name of the builtin
+ @return The builtin SExpr or NILObj if there is no builtin with that name
  */
-SExpr evalOr(SExpr args, SExpr env);
+SExpr findBuiltin(const char *name);
 
 /**
-    Evals let
- @param pairs List of varaible value pairs (as lists)
- @param expr The expression to evaluate and apply the args to
- @param env The environemnt to eval to
- @return The evlauated expression
+    set! special form eval (assigns variables in the environmet)
+ @param name The name for the variable
+ @param value The value to assign to the variable, already evaluated
+ @param env  The local scope
+ @return NIL for now
  */
-SExpr evalLet(SExpr pairs, SExpr expr, SExpr env);
+SExpr evalSETBang(SExpr name, SExpr value, SExpr env);
 
 /**
-    Eval Progn (Lisp name, equivalent to Scheme begin, same behavior)
- @param exprs The list of expressions to evaluate
- @param env The environemnt to eval to
- @return The last evaled expression
+    Calls a lambda, binding its parameters onto its environment and running its analyzed body
+ @param lambda  The lambda
+ @param argc The number of arguments
+ @param argv The arguments
+ @return The result as an SExpr
  */
-SExpr evalProgn(SExpr exprs, SExpr env);
+SExpr evalLambda(Lambda *lambda, int argc, SExpr *argv);
 
 /**
-    Eval apply
- @param func The function to evaluate
- @param args The aguments to the function
- @param env The environemnt to eval to
- @return The evaluated function
+    Wrapper for env
+ @param args The arguments, needs to be NIL
+ @return The result of env
  */
-SExpr evalApply(SExpr func, SExpr args, SExpr env);
+SExpr env(SExpr args);
 
 #endif /* eval_h */
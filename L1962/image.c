@@ -0,0 +1,595 @@
+//
+//  image.c
+//      Saves and restores a fully initialized heap so startup does not re-read init.lisp
+//  L1962
+//
+
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "image.h"
+#include "eval.h"
+#include "pointerMap.h"
+#include "records.h"
+#include "vectors.h"
+
+#define IMAGE_MAGIC "L1962IMG"
+#define IMAGE_VERSION 3
+#define IMAGE_VECTOR_HEADER ((sizeof(Vector) + VECTOR_ALIGNMENT - 1) & ~(uint64_t) (VECTOR_ALIGNMENT - 1))
+#define IMAGE_LAYOUT ((uint32_t) (sizeof(SExpr) | (sizeof(Cons) << 8) | (sizeof(Lambda) << 16)))
+
+/**
+    ImageHeader Struct, the start of every image file
+    Every pointer inside the image is stored in the SExpr union as an offset from the start of the file
+ */
+typedef struct ImageHeader ImageHeader;
+struct ImageHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t layout;        // Struct sizes of the binary that wrote the image
+    uint64_t stringsOffset; // Pool of NUL terminated symbols and builtin names
+    uint64_t stringsSize;
+    uint64_t blobsOffset;   // STRING and BYTEVECTOR storage, each a length word, the bytes and a NUL, padded to 8
+    uint64_t blobsSize;
+    uint64_t recordsOffset; // Each record laid out as a Record, its type the offset of its descriptor (0 for the type of types)
+    uint64_t recordsSize;
+    uint64_t vectorsOffset; // Each vector a Vector padded to VECTOR_ALIGNMENT followed by its padded elements
+    uint64_t vectorsSize;
+    uint64_t consOffset;    // Array of Cons
+    uint64_t consCount;
+    uint64_t lambdaOffset;  // Array of Lambda
+    uint64_t lambdaCount;
+    SExpr root;
+};
+
+/**
+    ImageWriter Struct, the objects found while walking the heap and where they will be written
+ */
+typedef struct ImageWriter ImageWriter;
+struct ImageWriter {
+    PointerMap conses;      // Cons * -> index
+    PointerMap lambdas;     // Lambda * -> index
+    PointerMap strings;     // const char * -> offset in the pool
+    PointerMap blobs;       // STRING or BYTEVECTOR bytes -> offset of the bytes in the blob section
+    PointerMap records;     // Record * -> offset in the record section
+    PointerMap vectors;     // Vector * -> offset in the vector section
+    Cons **consList;
+    size_t consCount;
+    size_t consCapacity;
+    Lambda **lambdaList;
+    size_t lambdaCount;
+    size_t lambdaCapacity;
+    const char **stringList;
+    size_t stringCount;
+    size_t stringCapacity;
+    uint64_t stringsSize;
+    SExpr *blobList;
+    size_t blobCount;
+    size_t blobCapacity;
+    uint64_t blobsSize;
+    Record **recordList;
+    size_t recordCount;
+    size_t recordCapacity;
+    uint64_t recordsSize;
+    Vector **vectorList;
+    size_t vectorCount;
+    size_t vectorCapacity;
+    uint64_t vectorsSize;
+    size_t skipped;         // Ports and futures, saved as NIL
+    ImageHeader header;
+};
+
+/**
+    Makes room for one more element in a growable array (private)
+ @param array The array
+ @param capacity The capacity of the array, updated
+ @param count The number of elements in use
+ @param elementSize The size of an element
+ @return The (possibly moved) array
+ */
+static void *imageGrow(void *array, size_t *capacity, size_t count, size_t elementSize) {
+    if (count >= *capacity) {
+        *capacity = (*capacity == 0) ? 64 : *capacity * 2;
+        array = realloc(array, *capacity * elementSize);
+    }
+    return array;
+}
+
+/**
+    Adds a string to the pool if it is not already there (private)
+ @param writer The writer
+ @param s The string
+ */
+static void imageString(ImageWriter *writer, const char *s) {
+    if (!pointerMapGet(&writer->strings, s, NULL)) {
+        pointerMapPut(&writer->strings, s, writer->stringsSize);
+        writer->stringList = imageGrow(writer->stringList, &writer->stringCapacity, writer->stringCount, sizeof(char *));
+        writer->stringList[writer->stringCount++] = s;
+        writer->stringsSize += strlen(s) + 1;
+    }
+}
+
+/**
+    The space a STRING or BYTEVECTOR takes in the blob section (private)
+ @param expr The STRING or BYTEVECTOR
+ @return The size, a multiple of 8
+ */
+static uint64_t imageBlobSize(SExpr expr) {
+    return (sizeof(size_t) + stringLength(expr) + 1 + 7) & ~(uint64_t) 7;
+}
+
+/**
+    Adds a STRING or BYTEVECTOR to the blob section if it is not already there (private)
+ @param writer The writer
+ @param expr The STRING or BYTEVECTOR
+ */
+static void imageBlob(ImageWriter *writer, SExpr expr) {
+    if (!pointerMapGet(&writer->blobs, expr.string, NULL)) {
+        pointerMapPut(&writer->blobs, expr.string, writer->blobsSize + sizeof(size_t));
+        writer->blobList = imageGrow(writer->blobList, &writer->blobCapacity, writer->blobCount, sizeof(SExpr));
+        writer->blobList[writer->blobCount++] = expr;
+        writer->blobsSize += imageBlobSize(expr);
+    }
+}
+
+/**
+    The space a vector takes in the vector section, padded like allocVector pads it (private)
+ @param vector The vector
+ @return The size, a multiple of VECTOR_ALIGNMENT
+ */
+static uint64_t imageVectorSize(const Vector *vector) {
+    uint64_t size = (vector->length * sizeof(double) + VECTOR_ALIGNMENT - 1) & ~(uint64_t) (VECTOR_ALIGNMENT - 1);
+    return IMAGE_VECTOR_HEADER + ((size > 0) ? size : VECTOR_ALIGNMENT);
+}
+
+/**
+    Walks everything reachable from root with an explicit stack, numbering conses and lambdas (private)
+ @param writer The writer
+ @param root The SExpr to start from
+ */
+static void imageVisit(ImageWriter *writer, SExpr root) {
+    size_t count = 0;
+    size_t capacity = 0;
+    SExpr *stack = NULL;
+    stack = imageGrow(stack, &capacity, count, sizeof(SExpr));
+    stack[count++] = root;
+    while (count > 0) {
+        SExpr expr = stack[--count];
+        switch (expr.type) {
+            case CONS:
+                if (!pointerMapGet(&writer->conses, expr.cons, NULL)) {
+                    pointerMapPut(&writer->conses, expr.cons, writer->consCount);
+                    writer->consList = imageGrow(writer->consList, &writer->consCapacity, writer->consCount, sizeof(Cons *));
+                    writer->consList[writer->consCount++] = expr.cons;
+                    stack = imageGrow(stack, &capacity, count + 1, sizeof(SExpr));
+                    stack[count++] = expr.cons->cdr;
+                    stack[count++] = expr.cons->car;
+                }
+                break;
+                
+            case LAMBDA:
+            case MACRO:
+                if (!pointerMapGet(&writer->lambdas, expr.lambda, NULL)) {
+                    pointerMapPut(&writer->lambdas, expr.lambda, writer->lambdaCount);
+                    writer->lambdaList = imageGrow(writer->lambdaList, &writer->lambdaCapacity, writer->lambdaCount, sizeof(Lambda *));
+                    writer->lambdaList[writer->lambdaCount++] = expr.lambda;
+                    stack = imageGrow(stack, &capacity, count + 2, sizeof(SExpr));
+                    stack[count++] = expr.lambda->env;
+                    stack[count++] = expr.lambda->exprs;
+                    stack[count++] = expr.lambda->params;
+                }
+                break;
+                
+            case RECORD:
+                if (expr.record != recordTypeDescriptor() && !pointerMapGet(&writer->records, expr.record, NULL)) {
+                    pointerMapPut(&writer->records, expr.record, writer->recordsSize);
+                    writer->recordList = imageGrow(writer->recordList, &writer->recordCapacity, writer->recordCount, sizeof(Record *));
+                    writer->recordList[writer->recordCount++] = expr.record;
+                    writer->recordsSize += sizeof(Record) + expr.record->count * sizeof(SExpr);
+                    for (size_t i = 0; i <= expr.record->count; i++) {
+                        stack = imageGrow(stack, &capacity, count, sizeof(SExpr));
+                        if (i == expr.record->count) {
+                            stack[count].type = RECORD;
+                            stack[count++].record = expr.record->type;
+                        } else {
+                            stack[count++] = expr.record->fields[i];
+                        }
+                    }
+                }
+                break;
+                
+            case F64VECTOR:
+            case S64VECTOR:
+                if (!pointerMapGet(&writer->vectors, expr.vector, NULL)) {
+                    pointerMapPut(&writer->vectors, expr.vector, writer->vectorsSize);
+                    writer->vectorList = imageGrow(writer->vectorList, &writer->vectorCapacity, writer->vectorCount, sizeof(Vector *));
+                    writer->vectorList[writer->vectorCount++] = expr.vector;
+                    writer->vectorsSize += imageVectorSize(expr.vector);
+                }
+                break;
+                
+            case SYMBOL:
+                imageString(writer, expr.symbol);
+                break;
+                
+            case STRING:
+            case BYTEVECTOR:
+                imageBlob(writer, expr);
+                break;
+                
+            case PORT:
+            case FUTURE:
+                writer->skipped++;
+                break;
+                
+            case BUILTIN:
+            {
+                const char *name = builtinName(expr);
+                if (name == NULL) {
+                    free(stack);
+                    fail("Cannot save an unregistered builtin in an image");
+                }
+                imageString(writer, name);
+                break;
+            }
+                
+            case NIL:
+            case INT:
+            case REAL:
+            case CHAR:
+            case END:
+                break;
+                
+            default:
+                free(stack);
+                fail("Cannot save an SExpr of type %s in an image", SExprName(expr.type));
+        }
+    }
+    free(stack);
+}
+
+/**
+    Converts an SExpr to its image form, replacing pointers by file offsets (private)
+ @param writer The writer
+ @param expr The SExpr to convert
+ @return The SExpr as it is stored in the image
+ */
+static SExpr imageRelative(ImageWriter *writer, SExpr expr) {
+    SExpr out;
+    size_t value = 0;
+    memset(&out, 0, sizeof(SExpr));
+    out.type = expr.type;
+    switch (expr.type) {
+        case CONS:
+            pointerMapGet(&writer->conses, expr.cons, &value);
+            out.i = writer->header.consOffset + value * sizeof(Cons);
+            break;
+            
+        case LAMBDA:
+        case MACRO:
+            pointerMapGet(&writer->lambdas, expr.lambda, &value);
+            out.i = writer->header.lambdaOffset + value * sizeof(Lambda);
+            break;
+            
+        case SYMBOL:
+            pointerMapGet(&writer->strings, expr.symbol, &value);
+            out.i = writer->header.stringsOffset + value;
+            break;
+            
+        case STRING:
+        case BYTEVECTOR:
+            pointerMapGet(&writer->blobs, expr.string, &value);
+            out.i = writer->header.blobsOffset + value;
+            break;
+            
+        case RECORD:
+            if (expr.record != recordTypeDescriptor()) {
+                pointerMapGet(&writer->records, expr.record, &value);
+                out.i = writer->header.recordsOffset + value;
+            } // Otherwise 0, the loading process has its own
+            break;
+            
+        case F64VECTOR:
+        case S64VECTOR:
+            pointerMapGet(&writer->vectors, expr.vector, &value);
+            out.i = writer->header.vectorsOffset + value;
+            break;
+            
+        case BUILTIN:
+            pointerMapGet(&writer->strings, builtinName(expr), &value);
+            out.i = writer->header.stringsOffset + value;
+            break;
+            
+        case PORT:
+        case FUTURE:
+            out.type = NIL;
+            break;
+            
+        default:
+            out = expr;
+            break;
+    }
+    return out;
+}
+
+void saveImage(const char *path, SExpr root) {
+    ImageWriter writer;
+    memset(&writer, 0, sizeof(ImageWriter));
+    pointerMapInit(&writer.conses);
+    pointerMapInit(&writer.lambdas);
+    pointerMapInit(&writer.strings);
+    pointerMapInit(&writer.blobs);
+    pointerMapInit(&writer.records);
+    pointerMapInit(&writer.vectors);
+    
+    imageVisit(&writer, root);
+    
+    // Lay out the file: header, string pool, blobs, records, vectors, conses, lambdas
+    ImageHeader *header = &writer.header;
+    memcpy(header->magic, IMAGE_MAGIC, sizeof(header->magic));
+    header->version = IMAGE_VERSION;
+    header->layout = IMAGE_LAYOUT;
+    header->stringsOffset = sizeof(ImageHeader);
+    header->stringsSize = writer.stringsSize;
+    header->blobsOffset = (header->stringsOffset + header->stringsSize + 7) & ~(uint64_t) 7;
+    header->blobsSize = writer.blobsSize;
+    header->recordsOffset = header->blobsOffset + header->blobsSize;
+    header->recordsSize = writer.recordsSize;
+    header->vectorsOffset = (header->recordsOffset + header->recordsSize + VECTOR_ALIGNMENT - 1) & ~(uint64_t) (VECTOR_ALIGNMENT - 1);
+    header->vectorsSize = writer.vectorsSize;
+    header->consOffset = header->vectorsOffset + header->vectorsSize;
+    header->consCount = writer.consCount;
+    header->lambdaOffset = header->consOffset + header->consCount * sizeof(Cons);
+    header->lambdaCount = writer.lambdaCount;
+    header->root = imageRelative(&writer, root);
+    
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) {
+        fail("can't open image for writing: %s", path);
+    }
+    fwrite(header, sizeof(ImageHeader), 1, fp);
+    for (size_t i = 0; i < writer.stringCount; i++) {
+        fwrite(writer.stringList[i], strlen(writer.stringList[i]) + 1, 1, fp);
+    }
+    static const char padding[VECTOR_ALIGNMENT] = {0};
+    fwrite(padding, header->blobsOffset - header->stringsOffset - header->stringsSize, 1, fp);
+    for (size_t i = 0; i < writer.blobCount; i++) {
+        SExpr blob = writer.blobList[i];
+        size_t length = stringLength(blob);
+        fwrite(&length, sizeof(size_t), 1, fp);
+        fwrite(blob.string, length + 1, 1, fp);
+        fwrite(padding, imageBlobSize(blob) - sizeof(size_t) - length - 1, 1, fp);
+    }
+    for (size_t i = 0; i < writer.recordCount; i++) {
+        Record *record = writer.recordList[i];
+        SExpr type;
+        type.type = RECORD;
+        type.record = record->type;
+        Record out;
+        out.type = (Record *) (uintptr_t) imageRelative(&writer, type).i;
+        out.count = record->count;
+        fwrite(&out, sizeof(Record), 1, fp);
+        for (size_t j = 0; j < record->count; j++) {
+            SExpr field = imageRelative(&writer, record->fields[j]);
+            fwrite(&field, sizeof(SExpr), 1, fp);
+        }
+    }
+    fwrite(padding, header->vectorsOffset - header->recordsOffset - header->recordsSize, 1, fp);
+    for (size_t i = 0; i < writer.vectorCount; i++) {
+        Vector out;
+        memset(&out, 0, sizeof(Vector));
+        out.length = writer.vectorList[i]->length;
+        fwrite(&out, sizeof(Vector), 1, fp);
+        fwrite(padding, IMAGE_VECTOR_HEADER - sizeof(Vector), 1, fp);
+        fwrite(writer.vectorList[i]->f64, sizeof(double), out.length, fp);
+        fwrite(padding, imageVectorSize(&out) - IMAGE_VECTOR_HEADER - out.length * sizeof(double), 1, fp);
+    }
+    for (size_t i = 0; i < writer.consCount; i++) {
+        Cons cons;
+        cons.car = imageRelative(&writer, writer.consList[i]->car);
+        cons.cdr = imageRelative(&writer, writer.consList[i]->cdr);
+        fwrite(&cons, sizeof(Cons), 1, fp);
+    }
+    for (size_t i = 0; i < writer.lambdaCount; i++) {
+        Lambda lambda;
+        memset(&lambda, 0, sizeof(Lambda)); // Anything not saved starts out empty
+        lambda.params = imageRelative(&writer, writer.lambdaList[i]->params);
+        lambda.exprs = imageRelative(&writer, writer.lambdaList[i]->exprs);
+        lambda.env = imageRelative(&writer, writer.lambdaList[i]->env);
+        fwrite(&lambda, sizeof(Lambda), 1, fp);
+    }
+    int failed = ferror(fp);
+    fclose(fp);
+    
+    pointerMapFree(&writer.conses);
+    pointerMapFree(&writer.lambdas);
+    pointerMapFree(&writer.strings);
+    pointerMapFree(&writer.blobs);
+    pointerMapFree(&writer.records);
+    pointerMapFree(&writer.vectors);
+    free(writer.consList);
+    free(writer.lambdaList);
+    free(writer.stringList);
+    free(writer.blobList);
+    free(writer.recordList);
+    free(writer.vectorList);
+    if (failed) {
+        fail("error writing image: %s", path);
+    }
+    if (writer.skipped > 0) {
+        fprintf(stderr, "save-image: %zu ports or futures can't be saved, they load as nil\n", writer.skipped);
+    }
+}
+
+/**
+    Checks that an offset into the image lands inside the given section (private)
+ @param offset The offset to check
+ @param start The start of the section
+ @param size The size of the section
+ @param elementSize The size of what the offset points to
+ */
+static void imageCheckOffset(int64_t offset, uint64_t start, uint64_t size, uint64_t elementSize) {
+    if (offset < (int64_t) start || (uint64_t) offset + elementSize > start + size) {
+        fail("Corrupt image: offset %lld out of range", (long long) offset);
+    }
+}
+
+/**
+    Turns the offset of a record inside the image into a pointer (private)
+ @param base The start of the mapping
+ @param header The image header
+ @param offset The offset, 0 for the type of type descriptors
+ @return The record
+ */
+static Record *imageRecord(char *base, const ImageHeader *header, int64_t offset) {
+    if (offset == 0) {
+        return recordTypeDescriptor();
+    }
+    imageCheckOffset(offset, header->recordsOffset, header->recordsSize, sizeof(Record));
+    return (Record *) (base + offset);
+}
+
+/**
+    Turns the offsets of an SExpr inside the mapped image back into pointers (private)
+ @param base The start of the mapping
+ @param header The image header
+ @param expr The SExpr to relocate in place
+ */
+static void imageRelocate(char *base, const ImageHeader *header, SExpr *expr) {
+    switch (expr->type) {
+        case CONS:
+            imageCheckOffset(expr->i, header->consOffset, header->consCount * sizeof(Cons), sizeof(Cons));
+            expr->cons = (Cons *) (base + expr->i);
+            break;
+            
+        case LAMBDA:
+        case MACRO:
+            imageCheckOffset(expr->i, header->lambdaOffset, header->lambdaCount * sizeof(Lambda), sizeof(Lambda));
+            expr->lambda = (Lambda *) (base + expr->i);
+            break;
+            
+        case RECORD:
+            expr->record = imageRecord(base, header, expr->i);
+            break;
+            
+        case F64VECTOR:
+        case S64VECTOR:
+            imageCheckOffset(expr->i, header->vectorsOffset, header->vectorsSize, IMAGE_VECTOR_HEADER);
+            expr->vector = (Vector *) (base + expr->i);
+            break;
+            
+        case SYMBOL:
+            imageCheckOffset(expr->i, header->stringsOffset, header->stringsSize, 1);
+            expr->symbol = struniqNoCopy(base + expr->i);
+            break;
+            
+        case STRING:
+        case BYTEVECTOR:
+        {
+            if (header->blobsSize < sizeof(size_t)) {
+                fail("Corrupt image: string without a blob section");
+            }
+            imageCheckOffset(expr->i, header->blobsOffset + sizeof(size_t), header->blobsSize - sizeof(size_t), 1);
+            size_t length;
+            memcpy(&length, base + expr->i - sizeof(size_t), sizeof(size_t));
+            imageCheckOffset(expr->i, header->blobsOffset, header->blobsSize, (uint64_t) length + 1);
+            expr->string = base + expr->i;
+            break;
+        }
+            
+        case BUILTIN:
+        {
+            imageCheckOffset(expr->i, header->stringsOffset, header->stringsSize, 1);
+            SExpr builtin = findBuiltin(struniqNoCopy(base + expr->i));
+            if (isNIL(builtin)) {
+                fail("Image refers to an unknown builtin: %s", base + expr->i);
+            }
+            *expr = builtin;
+            break;
+        }
+            
+        default:
+            break;
+    }
+}
+
+SExpr loadImage(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fail("can't open image: %s", path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(ImageHeader)) {
+        close(fd);
+        fail("not an image: %s", path);
+    }
+    char *base = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0); // The mapping becomes the heap, never unmapped
+    close(fd);
+    if (base == MAP_FAILED) {
+        fail("can't map image: %s", path);
+    }
+    
+    ImageHeader *header = (ImageHeader *) base;
+    if (memcmp(header->magic, IMAGE_MAGIC, sizeof(header->magic)) != 0 || header->version != IMAGE_VERSION || header->layout != IMAGE_LAYOUT) {
+        munmap(base, st.st_size);
+        fail("not an image for this version of L1962: %s", path);
+    }
+    if (header->stringsOffset + header->stringsSize > (uint64_t) st.st_size
+        || header->blobsOffset + header->blobsSize > (uint64_t) st.st_size
+        || header->recordsOffset + header->recordsSize > (uint64_t) st.st_size
+        || header->vectorsOffset + header->vectorsSize > (uint64_t) st.st_size
+        || header->vectorsOffset % VECTOR_ALIGNMENT != 0
+        || header->consOffset + header->consCount * sizeof(Cons) > (uint64_t) st.st_size
+        || header->lambdaOffset + header->lambdaCount * sizeof(Lambda) > (uint64_t) st.st_size
+        || (header->stringsSize > 0 && base[header->stringsOffset + header->stringsSize - 1] != 0)) {
+        munmap(base, st.st_size);
+        fail("Corrupt image: %s", path);
+    }
+    
+    // Records and vectors are walked in order, each one's size follows from its count or length
+    for (uint64_t offset = 0; offset < header->recordsSize; ) {
+        Record *record = (Record *) (base + header->recordsOffset + offset);
+        if (header->recordsSize - offset < sizeof(Record) || record->count > (header->recordsSize - offset - sizeof(Record)) / sizeof(SExpr)) {
+            fail("Corrupt image: record out of range");
+        }
+        record->type = imageRecord(base, header, (int64_t) (uintptr_t) record->type);
+        for (size_t i = 0; i < record->count; i++) {
+            imageRelocate(base, header, &record->fields[i]);
+        }
+        offset += sizeof(Record) + record->count * sizeof(SExpr);
+    }
+    for (uint64_t offset = 0; offset < header->vectorsSize; ) {
+        Vector *vector = (Vector *) (base + header->vectorsOffset + offset);
+        if (header->vectorsSize - offset < IMAGE_VECTOR_HEADER || vector->length > (header->vectorsSize - offset - IMAGE_VECTOR_HEADER) / sizeof(double)) {
+            fail("Corrupt image: vector out of range");
+        }
+        vector->f64 = (double *) ((char *) vector + IMAGE_VECTOR_HEADER);
+        offset += imageVectorSize(vector);
+    }
+    Cons *conses = (Cons *) (base + header->consOffset);
+    for (uint64_t i = 0; i < header->consCount; i++) {
+        imageRelocate(base, header, &conses[i].car);
+        imageRelocate(base, header, &conses[i].cdr);
+    }
+    Lambda *lambdas = (Lambda *) (base + header->lambdaOffset);
+    for (uint64_t i = 0; i < header->lambdaCount; i++) {
+        imageRelocate(base, header, &lambdas[i].params);
+        imageRelocate(base, header, &lambdas[i].exprs);
+        imageRelocate(base, header, &lambdas[i].env);
+    }
+    SExpr root = header->root;
+    imageRelocate(base, header, &root);
+    return root;
+}
+
+SExpr evalSaveImage(SExpr args) {
+    check(isNIL(cdr(args)));
+    SExpr path = car(args);
+    check(path.type == STRING);
+    saveImage(path.string, global);
+    return path;
+}
@@ -0,0 +1,35 @@
+//
+//  image.h
+//      Saves and restores a fully initialized heap so startup does not re-read init.lisp
+//  L1962
+//
+
+#ifndef image_h
+#define image_h
+
+#include "SExpr.h"
+
+/**
+    Writes everything reachable from root (conses, lambdas, symbols, strings, records, vectors, builtins) into a relocatable image file
+    Pointers are stored as offsets into the file and builtins by their registered name, ports and futures are saved as NIL
+ @param path The file to write the image to
+ @param root The SExpr to save (normally the global environment)
+ */
+void saveImage(const char *path, SExpr root);
+
+/**
+    Maps an image written by saveImage back into memory (copy on write) and relocates it in place
+    Symbols are interned straight out of the mapping and builtins are resolved by name, so evalInit must have been called
+ @param path The image file to load
+ @return The root SExpr that was saved
+ */
+SExpr loadImage(const char *path);
+
+/**
+    save-image builtin, saves the global environment
+ @param args The list holding the path string
+ @return The path
+ */
+SExpr evalSaveImage(SExpr args);
+
+#endif /* image_h */
@@ -0,0 +1,291 @@
+//
+//  lists.c
+//      Native list library, the core list functions init.lisp used to define plus the usual higher-order ones
+//  L1962
+//
+
+#include "lists.h"
+#include "eval.h"
+#include "vectors.h"
+
+/**
+    ListBuilder Struct, builds a list front to back without reversing (private)
+ */
+typedef struct ListBuilder ListBuilder;
+struct ListBuilder {
+    SExpr head;
+    SExpr last;
+};
+
+/**
+    Starts an empty list (private)
+ @param builder The builder
+ */
+static void listBuilderInit(ListBuilder *builder) {
+    builder->head = NILObj;
+    builder->last = NILObj;
+}
+
+/**
+    Adds an element at the end of the list (private)
+ @param builder The builder
+ @param item The element
+ */
+static void listBuilderAdd(ListBuilder *builder, SExpr item) {
+    SExpr cell = consToSExpr(item, NILObj);
+    if (isNIL(builder->last)) {
+        builder->head = cell;
+    } else {
+        builder->last.cons->cdr = cell;
+    }
+    builder->last = cell;
+}
+
+/**
+    Ends the list with a tail instead of NIL (private)
+ @param builder The builder
+ @param tail The tail
+ @return The list
+ */
+static SExpr listBuilderFinish(ListBuilder *builder, SExpr tail) {
+    if (isNIL(builder->last)) {
+        return tail;
+    }
+    builder->last.cons->cdr = tail;
+    return builder->head;
+}
+
+SExpr evalLength(int argc, SExpr *argv) {
+    check(argc == 1);
+    return length(argv[0]);
+}
+
+SExpr evalList(int argc, SExpr *argv) {
+    return arrayToList(argc, argv);
+}
+
+SExpr evalListStar(int argc, SExpr *argv) {
+    check(argc > 0);
+    SExpr list = argv[argc - 1];
+    for (int i = argc - 2; i >= 0; i--) {
+        list = consToSExpr(argv[i], list);
+    }
+    return list;
+}
+
+SExpr evalLast(int argc, SExpr *argv) {
+    check(argc == 1);
+    SExpr list = argv[0];
+    if (isNIL(list)) {
+        return NILObj;
+    }
+    check(isCONS(list));
+    while (isCONS(uncheckedCdr(list))) {
+        list = uncheckedCdr(list);
+    }
+    return list;
+}
+
+SExpr evalMax(int argc, SExpr *argv) {
+    check(argc > 0);
+    SExpr result = argv[0];
+    for (int i = 1; i < argc; i++) {
+        if (isNIL(greater(result, argv[i]))) {
+            result = argv[i];
+        }
+    }
+    return result;
+}
+
+SExpr evalMin(int argc, SExpr *argv) {
+    check(argc > 0);
+    SExpr result = argv[0];
+    for (int i = 1; i < argc; i++) {
+        if (!isNIL(greater(result, argv[i]))) {
+            result = argv[i];
+        }
+    }
+    return result;
+}
+
+SExpr evalAvg(int argc, SExpr *argv) {
+    check(argc == 1);
+    if (isVector(argv[0])) { // Summed by the vector kernel
+        check(argv[0].vector->length > 0);
+        SExpr terms[2] = { vectorSum(argv[0]), intToSExpr((int64_t) argv[0].vector->length) };
+        return divideSExpr(2, terms);
+    }
+    SExpr count = length(argv[0]);
+    SExpr *items = malloc((count.i > 0 ? count.i : 1) * sizeof(SExpr));
+    size_t i = 0;
+    for (SExpr current = argv[0]; isCONS(current); current = uncheckedCdr(current)) {
+        items[i++] = uncheckedCar(current);
+    }
+    SExpr terms[2];
+    terms[0] = addSExpr((int) count.i, items);
+    terms[1] = count;
+    free(items);
+    return divideSExpr(2, terms);
+}
+
+SExpr evalListAppend(int argc, SExpr *argv) {
+    if (argc == 0) {
+        return NILObj;
+    }
+    ListBuilder builder;
+    listBuilderInit(&builder);
+    for (int i = 0; i < argc - 1; i++) {
+        SExpr current;
+        for (current = argv[i]; isCONS(current); current = uncheckedCdr(current)) {
+            listBuilderAdd(&builder, uncheckedCar(current));
+        }
+        check(isNIL(current));
+    }
+    return listBuilderFinish(&builder, argv[argc - 1]);
+}
+
+SExpr evalReverse(int argc, SExpr *argv) {
+    check(argc == 1);
+    SExpr reversed = NILObj;
+    SExpr current;
+    for (current = argv[0]; isCONS(current); current = uncheckedCdr(current)) {
+        reversed = consToSExpr(uncheckedCar(current), reversed);
+    }
+    check(isNIL(current));
+    return reversed;
+}
+
+SExpr evalMap(int argc, SExpr *argv) {
+    check(argc >= 2);
+    ListBuilder builder;
+    listBuilderInit(&builder);
+    if (argc == 2) {
+        for (SExpr current = argv[1]; isCONS(current); current = uncheckedCdr(current)) {
+            SExpr item = uncheckedCar(current);
+            listBuilderAdd(&builder, callFunction(argv[0], 1, &item));
+        }
+        return builder.head;
+    }
+    int lists = argc - 1;
+    SExpr *currents = malloc(lists * sizeof(SExpr));
+    SExpr *items = malloc(lists * sizeof(SExpr));
+    for (int i = 0; i < lists; i++) {
+        currents[i] = argv[i + 1];
+    }
+    for (;;) {
+        for (int i = 0; i < lists; i++) {
+            if (!isCONS(currents[i])) {
+                free(currents);
+                free(items);
+                return builder.head;
+            }
+            items[i] = uncheckedCar(currents[i]);
+            currents[i] = uncheckedCdr(currents[i]);
+        }
+        listBuilderAdd(&builder, callFunction(argv[0], lists, items));
+    }
+}
+
+SExpr evalFilter(int argc, SExpr *argv) {
+    check(argc == 2);
+    ListBuilder builder;
+    listBuilderInit(&builder);
+    for (SExpr current = argv[1]; isCONS(current); current = uncheckedCdr(current)) {
+        SExpr item = uncheckedCar(current);
+        if (!isNIL(callFunction(argv[0], 1, &item))) {
+            listBuilderAdd(&builder, item);
+        }
+    }
+    return builder.head;
+}
+
+SExpr evalFold(int argc, SExpr *argv) {
+    check(argc == 3);
+    SExpr pair[2];
+    pair[1] = argv[1];
+    for (SExpr current = argv[2]; isCONS(current); current = uncheckedCdr(current)) {
+        pair[0] = uncheckedCar(current);
+        pair[1] = callFunction(argv[0], 2, pair);
+    }
+    return pair[1];
+}
+
+SExpr evalNth(int argc, SExpr *argv) {
+    check(argc == 2);
+    check(argv[0].type == INT && argv[0].i >= 0);
+    SExpr current = argv[1];
+    for (int64_t i = 0; i < argv[0].i && isCONS(current); i++) {
+        current = uncheckedCdr(current);
+    }
+    check(isCONS(current) || isNIL(current)); // An improper tail before the index is an error, not the end
+    return isCONS(current) ? uncheckedCar(current) : NILObj;
+}
+
+SExpr evalMember(int argc, SExpr *argv) {
+    check(argc == 2);
+    for (SExpr current = argv[1]; isCONS(current); current = uncheckedCdr(current)) {
+        if (!isNIL(eq(uncheckedCar(current), argv[0]))) {
+            return current;
+        }
+    }
+    return NILObj;
+}
+
+/**
+    Checks if a sorts before b (private)
+ @param predicate The predicate, NIL for <
+ @param a The first element
+ @param b The second element
+ @return 1 if a is less than b
+ */
+static int sortsBefore(SExpr predicate, SExpr a, SExpr b) {
+    if (isNIL(predicate)) {
+        return !isNIL(less(a, b));
+    }
+    SExpr pair[2];
+    pair[0] = a;
+    pair[1] = b;
+    return !isNIL(callFunction(predicate, 2, pair));
+}
+
+SExpr evalSort(int argc, SExpr *argv) {
+    check(argc == 1 || argc == 2);
+    SExpr predicate = (argc == 2) ? argv[1] : NILObj;
+    size_t count = (size_t) length(argv[0]).i;
+    SExpr *items = malloc((count > 0 ? count : 1) * sizeof(SExpr));
+    SExpr *scratch = malloc((count > 0 ? count : 1) * sizeof(SExpr));
+    size_t i = 0;
+    for (SExpr current = argv[0]; isCONS(current); current = uncheckedCdr(current)) {
+        items[i++] = uncheckedCar(current);
+    }
+    // Bottom up merge sort, taking from the right run only when it is strictly less keeps it stable
+    for (size_t width = 1; width < count; width *= 2) {
+        for (size_t start = 0; start < count; start += 2 * width) {
+            size_t middle = (start + width < count) ? start + width : count;
+            size_t end = (start + 2 * width < count) ? start + 2 * width : count;
+            size_t left = start;
+            size_t right = middle;
+            size_t out = start;
+            while (left < middle && right < end) {
+                if (sortsBefore(predicate, items[right], items[left])) {
+                    scratch[out++] = items[right++];
+                } else {
+                    scratch[out++] = items[left++];
+                }
+            }
+            while (left < middle) {
+                scratch[out++] = items[left++];
+            }
+            while (right < end) {
+                scratch[out++] = items[right++];
+            }
+        }
+        SExpr *swap = items;
+        items = scratch;
+        scratch = swap;
+    }
+    free(scratch);
+    SExpr sorted = arrayToList(count, items);
+    free(items);
+    return sorted;
+}
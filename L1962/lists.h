@@ -0,0 +1,132 @@
+//
+//  lists.h
+//      Native list library, the core list functions init.lisp used to define plus the usual higher-order ones
+//  L1962
+//
+
+#ifndef lists_h
+#define lists_h
+
+#include "SExpr.h"
+
+/**
+    length builtin, (length list)
+ @param argc The number of arguments, 1
+ @param argv The list
+ @return The number of elements as an INT
+ */
+SExpr evalLength(int argc, SExpr *argv);
+
+/**
+    list builtin, (list items...)
+ @param argc The number of items
+ @param argv The items
+ @return A fresh list of the items
+ */
+SExpr evalList(int argc, SExpr *argv);
+
+/**
+    list* builtin, (list* items... tail), the items consed onto the tail
+ @param argc The number of arguments, at least 1
+ @param argv The items followed by the tail
+ @return The list, only the tail itself for a single argument
+ */
+SExpr evalListStar(int argc, SExpr *argv);
+
+/**
+    last builtin, (last list)
+ @param argc The number of arguments, 1
+ @param argv The list
+ @return The last cons of the list, NIL for an empty list
+ */
+SExpr evalLast(int argc, SExpr *argv);
+
+/**
+    max builtin, (max numbers...), on ties the later argument wins as it did in init.lisp
+ @param argc The number of arguments, at least 1
+ @param argv The numbers
+ @return The largest
+ */
+SExpr evalMax(int argc, SExpr *argv);
+
+/**
+    min builtin, (min numbers...), on ties the earlier argument wins as it did in init.lisp
+ @param argc The number of arguments, at least 1
+ @param argv The numbers
+ @return The smallest
+ */
+SExpr evalMin(int argc, SExpr *argv);
+
+/**
+    avg builtin, (avg list), the sum divided by the length with the same arithmetic as + and /
+ @param argc The number of arguments, 1
+ @param argv The list of numbers, or an f64vector or s64vector
+ @return The average
+ */
+SExpr evalAvg(int argc, SExpr *argv);
+
+/**
+    append builtin, (append lists... tail), every list but the last is copied
+ @param argc The number of lists
+ @param argv The lists
+ @return The appended list, NIL for no arguments
+ */
+SExpr evalListAppend(int argc, SExpr *argv);
+
+/**
+    reverse builtin, (reverse list)
+ @param argc The number of arguments, 1
+ @param argv The list
+ @return A fresh reversed list
+ */
+SExpr evalReverse(int argc, SExpr *argv);
+
+/**
+    map builtin, (map function lists...), stops at the end of the shortest list
+ @param argc The number of arguments, at least 2
+ @param argv The function followed by the lists
+ @return The list of results
+ */
+SExpr evalMap(int argc, SExpr *argv);
+
+/**
+    filter builtin, (filter predicate list)
+ @param argc The number of arguments, 2
+ @param argv The predicate and the list
+ @return A fresh list of the elements the predicate is true for, in order
+ */
+SExpr evalFilter(int argc, SExpr *argv);
+
+/**
+    fold builtin, (fold function initial list), calls (function element accumulator) from the left
+ @param argc The number of arguments, 3
+ @param argv The function, the initial accumulator and the list
+ @return The final accumulator
+ */
+SExpr evalFold(int argc, SExpr *argv);
+
+/**
+    nth builtin, (nth n list), zero based
+ @param argc The number of arguments, 2
+ @param argv The index, not negative, and the list
+ @return The element, NIL past the end of the list
+ */
+SExpr evalNth(int argc, SExpr *argv);
+
+/**
+    member builtin, (member item list), compared with equal?
+ @param argc The number of arguments, 2
+ @param argv The item and the list
+ @return The sublist starting at the first match, NIL if there is none
+ */
+SExpr evalMember(int argc, SExpr *argv);
+
+/**
+    sort builtin, (sort list [less?]), a stable merge sort, < when no predicate is given
+ @param argc The number of arguments, 1 or 2
+ @param argv The list and the optional predicate
+ @return A fresh sorted list
+ */
+SExpr evalSort(int argc, SExpr *argv);
+
+#endif /* lists_h */
@@ -7,9 +7,12 @@
 
 #include <stdio.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "SExpr.h"
 #include "eval.h"
+#include "image.h"
+#include "Reader.h"
 
 
 /**
@@ -21,16 +24,22 @@ void readFile(FILE *fp, int print) {
     int isInteractive = isatty(fileno(fp)); // Checks if the given file is a console (ineractive) to allow for prompting
     int EOFBool = 1; // True while hasn't seen EOF
     int n = 1; // Environment saved variables
-    char str[5]; // Variable name string
+    char str[12]; // Variable name string
+    Buffer output; // Result line, written out in one piece
+    bufferInit(&output);
+    output.file = stdout;
+    Reader reader; // Reads the fd directly, so input is taken in large blocks and forms may span them
+    readerInitFd(&reader, fileno(fp));
     
     while (EOFBool) {
         if (isInteractive) {
             printf("> "); // Simple prompting, prints if console is being read
+            fflush(stdout); // The reader doesn't go through stdio, which would flush it
         }
         TRY_CATCH(e,
             {
-                SExpr expr = readSExpr(fp);
-                if (expr.type == END) {
+                SExpr expr;
+                if (readerNext(&reader, &expr) == READER_EOF) {
                     EOFBool = 0;
                     if(print){
                         printf("\n");
@@ -41,9 +50,12 @@ void readFile(FILE *fp, int print) {
                     if(print){
                         sprintf(str, "$%d", n);
                         evalSETBang(symbolToSExpr(struniq(str)), evaled, NILObj);
-                        printf("%s = ", str);
-                        printSExpr(evaled);
-                        printf("\n");
+                        output.length = 0;
+                        bufferString(&output, str);
+                        bufferAppend(&output, " = ", 3);
+                        writeSExpr(&output, evaled);
+                        bufferChar(&output, '\n');
+                        bufferFlush(&output); // One write per result
                         n++;
                     }
                 }
@@ -51,30 +63,121 @@ void readFile(FILE *fp, int print) {
                 printf("caught: %s\n", e.message);
             });
     }
+    readerFree(&reader);
+    bufferFree(&output);
 }
 
-int main(int argc, char **argv) {
-    hashInit();
-    SExprInit();
-    evalInit();
-    // Load initial files
+/**
+    Opens, evaluates, and prints a file given on the command line, reporting failures
+ @param path The file to run
+ */
+void runFile(const char *path) {
     TRY_CATCH(failure,
         {
-            printf("Loading: init.lisp\n");
-            FILE *fp = fopen("init.lisp", "r");
+            printf("%s: starting\n", path);
+            FILE *fp = fopen(path, "r");
             if (fp == NULL) {
-                fail("can't open file: init.lisp");
+                fail("can't open file: %s", path);
             }
             TRY_FINALLY({
-                readFile(fp, 0);
+                readFile(fp, 1);
                 }, {
                     fclose(fp);
+                    printf("cleaned up after %s\n", path);
                 });
-            printf("init.lisp loaded successfully\n");
+            printf("%s: finished successfully\n", path);
         }, {
-            fprintf(stderr, "failure on init.lisp: %s\n", failure.message);
+            fprintf(stderr, "failure on %s: %s\n", path, failure.message);
         });
-    if (argc == 1) {     // If one arg, tokenize stdin
+    printf("\n");
+}
+
+/**
+    FileJob Struct, a file to run on its own evaluator thread
+ */
+typedef struct FileJob FileJob;
+struct FileJob {
+    const char *path;
+    SExpr global; // Private copy of the initialized global environment
+    pthread_t thread;
+};
+
+/**
+    Thread entry point for -parallel, installs the job's environment and runs the file
+ @param arg The FileJob
+ @return NULL
+ */
+void *runFileThread(void *arg) {
+    FileJob *job = arg;
+    setGlobal(job->global);
+    runFile(job->path);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    hashInit();
+    SExprInit();
+    evalInit();
+    
+    const char *imagePath = NULL; // -image <file>: start from a saved image instead of init.lisp
+    const char *saveImagePath = NULL; // -save-image <file>: save the initialized environment
+    int parallel = 0; // -parallel: evaluate each file on its own thread with its own environment
+    int first = 1; // First file argument
+    while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-parallel") == 0) {
+            parallel = 1;
+            first += 1;
+        } else if (first + 1 < argc && strcmp(argv[first], "-image") == 0) {
+            imagePath = argv[first + 1];
+            first += 2;
+        } else if (first + 1 < argc && strcmp(argv[first], "-save-image") == 0) {
+            saveImagePath = argv[first + 1];
+            first += 2;
+        } else {
+            break;
+        }
+    }
+    
+    if (imagePath != NULL) {
+        TRY_CATCH(failure,
+            {
+                setGlobal(loadImage(imagePath));
+            }, {
+                fprintf(stderr, "failure on %s: %s\n", imagePath, failure.message);
+                return 1;
+            });
+    } else {
+        // Load initial files
+        TRY_CATCH(failure,
+            {
+                printf("Loading: init.lisp\n");
+                FILE *fp = fopen("init.lisp", "r");
+                if (fp == NULL) {
+                    fail("can't open file: init.lisp");
+                }
+                TRY_FINALLY({
+                    readFile(fp, 0);
+                    }, {
+                        fclose(fp);
+                    });
+                printf("init.lisp loaded successfully\n");
+            }, {
+                fprintf(stderr, "failure on init.lisp: %s\n", failure.message);
+            });
+    }
+    if (saveImagePath != NULL) {
+        TRY_CATCH(failure,
+            {
+                saveImage(saveImagePath, global);
+                printf("%s saved\n", saveImagePath);
+            }, {
+                fprintf(stderr, "failure on %s: %s\n", saveImagePath, failure.message);
+            });
+        if (first == argc) { // Nothing else to do
+            return 0;
+        }
+    }
+    if (first == argc) {     // If no file args, tokenize stdin
         TRY_CATCH(failure,
             {
                 readFile(stdin, 1);
@@ -82,25 +185,26 @@ int main(int argc, char **argv) {
                 fprintf(stderr, "failure on %s: %s\n", "stdin", failure.message);
             });
     } else {            // If more than one arg, args past calling arg will be files to tokenize
-        for (int i = 1; i < argc; i++) {
-            TRY_CATCH(failure,
-                {
-                    printf("%s: starting\n", argv[i]);
-                    FILE *fp = fopen(argv[i], "r");
-                    if (fp == NULL) {
-                        fail("can't open file: %s", argv[i]);
-                    }
-                    TRY_FINALLY({
-                        readFile(fp, 1);
-                        }, {
-                            fclose(fp);
-                            printf("cleaned up after %s\n", argv[i]);
-                        });
-                    printf("%s: finished successfully\n", argv[i]);
-                }, {
-                    fprintf(stderr, "failure on %s: %s\n", argv[i], failure.message);
-                });
-            printf("\n");
+        if (parallel) {
+            FileJob jobs[argc - first];
+            for (int i = first; i < argc; i++) {
+                FileJob *job = &jobs[i - first];
+                job->path = argv[i];
+                job->global = copyEnvironment(global);
+                if (pthread_create(&job->thread, NULL, runFileThread, job) != 0) {
+                    fprintf(stderr, "can't start thread for %s\n", argv[i]);
+                    job->path = NULL;
+                }
+            }
+            for (int i = 0; i < argc - first; i++) {
+                if (jobs[i].path != NULL) {
+                    pthread_join(jobs[i].thread, NULL);
+                }
+            }
+        } else {
+            for (int i = first; i < argc; i++) {
+                runFile(argv[i]);
+            }
         }
     }
     
@@ -0,0 +1,310 @@
+//
+//  parallel.c
+//      Data parallel builtins (pmap, pfor-each, preduce) on top of the thread pool
+//  L1962
+//
+
+#include <stdio.h>
+
+#include "parallel.h"
+#include "eval.h"
+#include "analyze.h"
+#include "threadPool.h"
+
+static atomic_long chunkSize = 0; // 0 picks a size from the list length and the worker count
+
+/**
+    Chunk Struct, a contiguous slice of the input handled by one task
+ */
+typedef struct Chunk Chunk;
+struct Chunk {
+    Task task;
+    SExpr function;
+    SExpr global;           // The environment of the thread that submitted the chunk
+    uint64_t epoch;         // and its epoch, so the worker's call site caches stay valid across chunks
+    SExpr *items;
+    SExpr *results;         // One per item for pmap, NULL otherwise
+    size_t count;
+    int reduce;             // Reduce the items into accumulator instead of mapping them
+    SExpr accumulator;
+    char *failure;          // strdup'ed message if applying the function failed
+};
+
+/**
+    Future Struct, an expression being evaluated on the pool
+ */
+struct Future {
+    Task task;
+    Node *node;
+    SExpr env;
+    SExpr global;           // The environment of the thread that made the future
+    uint64_t epoch;
+    SExpr value;
+    Failure failure;        // strdup'ed message if the evaluation failed
+};
+
+/**
+    Runs a chunk on whichever thread picked it up (private)
+ @param task The chunk
+ */
+static void runChunk(Task *task) {
+    Chunk *chunk = (Chunk *) task;
+    SExpr outer = global; // A waiting thread may be helping in the middle of its own evaluation
+    uint64_t outerEpoch = globalEpoch;
+    global = chunk->global;
+    globalEpoch = chunk->epoch;
+    TRY_CATCH(e,
+        {
+            if (chunk->reduce) {
+                SExpr accumulator = chunk->items[0];
+                for (size_t i = 1; i < chunk->count; i++) {
+                    SExpr pair[2]; // Separate stores, a braced list's comma would split the TRY_CATCH arguments
+                    pair[0] = accumulator;
+                    pair[1] = chunk->items[i];
+                    accumulator = callFunction(chunk->function, 2, pair);
+                }
+                chunk->accumulator = accumulator;
+            } else {
+                for (size_t i = 0; i < chunk->count; i++) {
+                    SExpr result = callFunction(chunk->function, 1, &chunk->items[i]);
+                    if (chunk->results != NULL) {
+                        chunk->results[i] = result;
+                    }
+                }
+            }
+        }, {
+            chunk->failure = strdup(e.message);
+        });
+    global = outer;
+    globalEpoch = outerEpoch;
+}
+
+/**
+    Copies the elements of a list into an array (private)
+ @param list The list
+ @param count Filled with the number of elements
+ @return The malloc'ed array of elements
+ */
+static SExpr *listToArray(SExpr list, size_t *count) {
+    size_t n = 0;
+    for (SExpr current = list; isCONS(current); current = uncheckedCdr(current)) {
+        n++;
+    }
+    SExpr *items = malloc((n > 0 ? n : 1) * sizeof(SExpr));
+    n = 0;
+    SExpr current;
+    for (current = list; isCONS(current); current = uncheckedCdr(current)) {
+        items[n++] = uncheckedCar(current);
+    }
+    if (!isNIL(current)) {
+        free(items);
+        fail("Parallel operation on an improper list");
+    }
+    *count = n;
+    return items;
+}
+
+/**
+    Splits items into chunks, runs them on the pool and waits for all of them (private)
+ @param function The function to apply
+ @param items The elements
+ @param count The number of elements
+ @param results The result array for pmap, or NULL
+ @param reduce Whether to reduce each chunk
+ @param size The chunk size argument (NIL for the default)
+ @param chunkCount Filled with the number of chunks
+ @return The chunks, in order, for the caller to free
+ */
+static Chunk *runChunks(SExpr function, SExpr *items, size_t count, SExpr *results, int reduce, SExpr size, size_t *chunkCount) {
+    check(function.type == LAMBDA || function.type == BUILTIN);
+    long perChunk = atomic_load(&chunkSize);
+    if (!isNIL(size)) {
+        check(size.type == INT);
+        perChunk = (long) size.i;
+    }
+    if (perChunk <= 0) { // A few chunks per worker so stealing can balance uneven work
+        perChunk = (long) (count / ((size_t) poolWorkers() * 4 + 4)) + 1;
+    }
+    size_t n = (count + perChunk - 1) / perChunk;
+    Chunk *chunks = calloc(n > 0 ? n : 1, sizeof(Chunk));
+    for (size_t i = 0; i < n; i++) {
+        Chunk *chunk = &chunks[i];
+        taskInit(&chunk->task, runChunk);
+        chunk->function = function;
+        chunk->global = global;
+        chunk->epoch = globalEpoch;
+        chunk->items = items + i * perChunk;
+        chunk->results = (results != NULL) ? results + i * perChunk : NULL;
+        chunk->count = (i == n - 1) ? count - i * perChunk : (size_t) perChunk;
+        chunk->reduce = reduce;
+    }
+    for (size_t i = n; i > 1; i--) { // The first chunk is run by this thread
+        taskSubmit(&chunks[i - 1].task);
+    }
+    if (n > 0) {
+        runChunk(&chunks[0].task);
+        atomic_store(&chunks[0].task.done, 1);
+    }
+    for (size_t i = 1; i < n; i++) {
+        taskWait(&chunks[i].task);
+    }
+    *chunkCount = n;
+    return chunks;
+}
+
+/**
+    Raises the first failure recorded by the chunks, freeing the work arrays first (private)
+ @param chunks The chunks
+ @param n The number of chunks
+ @param items The item array
+ @param results The result array (may be NULL)
+ */
+static void checkChunks(Chunk *chunks, size_t n, SExpr *items, SExpr *results) {
+    char *failure = NULL;
+    for (size_t i = 0; i < n; i++) {
+        if (chunks[i].failure != NULL) {
+            if (failure == NULL) {
+                failure = chunks[i].failure;
+            } else {
+                free(chunks[i].failure);
+            }
+        }
+    }
+    if (failure != NULL) {
+        char message[BUFSIZ];
+        snprintf(message, BUFSIZ, "%s", failure);
+        free(failure);
+        free(chunks);
+        free(items);
+        free(results);
+        fail("%s", message);
+    }
+}
+
+/**
+    Shared implementation of pmap and pfor-each (private)
+ @param args The builtin arguments
+ @param collect Whether to build the result list
+ @return The results or NIL
+ */
+static SExpr parallelMap(SExpr args, int collect) {
+    SExpr function = car(args);
+    SExpr list = cadr(args);
+    SExpr size = isNIL(cddr(args)) ? NILObj : car(cddr(args));
+    size_t count;
+    SExpr *items = listToArray(list, &count);
+    SExpr *results = collect ? malloc((count > 0 ? count : 1) * sizeof(SExpr)) : NULL;
+    size_t n;
+    Chunk *chunks = runChunks(function, items, count, results, 0, size, &n);
+    checkChunks(chunks, n, items, results);
+    SExpr out = NILObj;
+    if (collect) {
+        for (size_t i = count; i > 0; i--) {
+            out = consToSExpr(results[i - 1], out);
+        }
+    }
+    free(chunks);
+    free(items);
+    free(results);
+    return out;
+}
+
+SExpr evalPMap(SExpr args) {
+    return parallelMap(args, 1);
+}
+
+SExpr evalPForEach(SExpr args) {
+    return parallelMap(args, 0);
+}
+
+SExpr evalPReduce(SExpr args) {
+    SExpr function = car(args);
+    SExpr accumulator = cadr(args);
+    SExpr list = car(cddr(args));
+    SExpr size = isNIL(cdr(cddr(args))) ? NILObj : cadr(cddr(args));
+    size_t count;
+    SExpr *items = listToArray(list, &count);
+    size_t n;
+    Chunk *chunks = runChunks(function, items, count, NULL, 1, size, &n);
+    checkChunks(chunks, n, items, NULL);
+    for (size_t i = 0; i < n; i++) { // Combine in order, on this thread
+        SExpr pair[2] = { accumulator, chunks[i].accumulator };
+        accumulator = callFunction(function, 2, pair);
+    }
+    free(chunks);
+    free(items);
+    return accumulator;
+}
+
+SExpr evalSetParallelWorkers(SExpr args) {
+    check(isNIL(cdr(args)));
+    SExpr count = car(args);
+    check(count.type == INT && count.i > 0);
+    if (!poolSetWorkers((int) count.i)) {
+        fail("Parallel workers are already running (%d)", poolWorkers());
+    }
+    return count;
+}
+
+SExpr evalSetParallelChunkSize(SExpr args) {
+    check(isNIL(cdr(args)));
+    SExpr size = car(args);
+    check(size.type == INT && size.i >= 0);
+    atomic_store(&chunkSize, (long) size.i);
+    return size;
+}
+
+/**
+    Evaluates a future on whichever thread picked it up (private)
+ @param task The future
+ */
+static void runFuture(Task *task) {
+    Future *future = (Future *) task;
+    SExpr outer = global;
+    uint64_t outerEpoch = globalEpoch;
+    global = future->global;
+    globalEpoch = future->epoch;
+    TRY_CATCH(e,
+        {
+            future->value = runNode(future->node, future->env);
+        }, {
+            future->failure.message = strdup(e.message); // The failure buffer belongs to this thread
+        });
+    global = outer;
+    globalEpoch = outerEpoch;
+}
+
+SExpr evalFuture(Node *node, SExpr env) {
+    Future *future = malloc(sizeof(Future));
+    taskInit(&future->task, runFuture);
+    future->node = node;
+    future->env = env;
+    future->global = global;
+    future->epoch = globalEpoch;
+    future->value = NILObj;
+    future->failure.message = NULL;
+    taskSubmit(&future->task);
+    SExpr result;
+    result.type = FUTURE;
+    result.future = future;
+    return result;
+}
+
+SExpr evalTouch(SExpr args) {
+    check(isNIL(cdr(args)));
+    SExpr arg = car(args);
+    if (arg.type != FUTURE) {
+        return arg;
+    }
+    Future *future = arg.future;
+    taskWait(&future->task);
+    if (future->failure.message != NULL) {
+        RETHROW(future->failure);
+    }
+    return future->value;
+}
+
+SExpr evalIsFuture(SExpr args) {
+    check(isNIL(cdr(args)));
+    return (car(args).type == FUTURE) ? TObj : NILObj;
+}
@@ -0,0 +1,72 @@
+//
+//  parallel.h
+//      Data parallel builtins (pmap, pfor-each, preduce) on top of the thread pool
+//  L1962
+//
+
+#ifndef parallel_h
+#define parallel_h
+
+#include "SExpr.h"
+
+/**
+    pmap builtin, (pmap f list [chunk-size]), applies f to every element in parallel
+    f should be free of side effects, the results keep the order of list
+ @param args The function, the list and the optional chunk size
+ @return The list of results
+ */
+SExpr evalPMap(SExpr args);
+
+/**
+    pfor-each builtin, (pfor-each f list [chunk-size]), applies f to every element in parallel for its effect
+ @param args The function, the list and the optional chunk size
+ @return NIL
+ */
+SExpr evalPForEach(SExpr args);
+
+/**
+    preduce builtin, (preduce f init list [chunk-size]), reduces chunks in parallel then combines them in order
+    f must be associative, the result equals (f (f (f init x1) x2) ... xn)
+ @param args The function, the initial value, the list and the optional chunk size
+ @return The reduced value
+ */
+SExpr evalPReduce(SExpr args);
+
+/**
+    set-parallel-workers! builtin, sets the number of pool workers before the pool is first used
+ @param args The list holding the worker count
+ @return The worker count in effect
+ */
+SExpr evalSetParallelWorkers(SExpr args);
+
+/**
+    set-parallel-chunk-size! builtin, sets the default number of elements per task (0 for automatic)
+ @param args The list holding the chunk size
+ @return The chunk size
+ */
+SExpr evalSetParallelChunkSize(SExpr args);
+
+/**
+    future special form eval, starts running the analyzed expression on the pool
+ @param node The analyzed expression
+ @param env The environment to eval to
+ @return The FUTURE SExpr
+ */
+SExpr evalFuture(Node *node, SExpr env);
+
+/**
+    touch builtin, waits for a future (running other pending tasks meanwhile) and returns its value
+    A failure inside the future is rethrown here, anything that is not a future is returned as is
+ @param args The list holding the future
+ @return The value of the future
+ */
+SExpr evalTouch(SExpr args);
+
+/**
+    future? builtin
+ @param args The list holding the arg
+ @return TObj if the arg is a future
+ */
+SExpr evalIsFuture(SExpr args);
+
+#endif /* parallel_h */
@@ -0,0 +1,86 @@
+//
+//  pointerMap.c
+//  L1962
+//
+
+#include "pointerMap.h"
+
+/**
+    Hashes an address, mixes the high bits down since allocations are aligned (private)
+ @param key The address to hash
+ @param size The size of the table
+ @return The starting slot
+ */
+static size_t pointerHashing(const void *key, size_t size) {
+    uintptr_t h = (uintptr_t) key;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h % size;
+}
+
+void pointerMapInit(PointerMap *map) {
+    map->size = 61;
+    map->stored = 0;
+    map->keys = calloc(map->size, sizeof(void *));
+    map->values = malloc(map->size * sizeof(size_t));
+}
+
+void pointerMapFree(PointerMap *map) {
+    free(map->keys);
+    free(map->values);
+    map->keys = NULL;
+    map->values = NULL;
+    map->size = 0;
+    map->stored = 0;
+}
+
+/**
+    Resizes the PointerMap by 2n+1 when it is 3/4 full (private)
+ @param map The map to resize
+ */
+static void pointerMapResize(PointerMap *map) {
+    if (map->stored >= (map->size * 3 / 4)) {
+        size_t oldSize = map->size;
+        const void **oldKeys = map->keys;
+        size_t *oldValues = map->values;
+        map->size = 2 * oldSize + 1;
+        map->keys = calloc(map->size, sizeof(void *));
+        map->values = malloc(map->size * sizeof(size_t));
+        map->stored = 0;
+        for (size_t i = 0; i < oldSize; i++) { // Copy
+            if (oldKeys[i] != NULL) {
+                pointerMapPut(map, oldKeys[i], oldValues[i]);
+            }
+        }
+        free(oldKeys);
+        free(oldValues);
+    }
+}
+
+int pointerMapGet(const PointerMap *map, const void *key, size_t *value) {
+    size_t index = pointerHashing(key, map->size);
+    while (map->keys[index] != NULL) {
+        if (map->keys[index] == key) {
+            if (value != NULL) {
+                *value = map->values[index];
+            }
+            return 1;
+        }
+        index = (index + 1) % map->size;
+    }
+    return 0;
+}
+
+void pointerMapPut(PointerMap *map, const void *key, size_t value) {
+    pointerMapResize(map);
+    size_t index = pointerHashing(key, map->size);
+    while (map->keys[index] != NULL && map->keys[index] != key) {
+        index = (index + 1) % map->size;
+    }
+    if (map->keys[index] == NULL) {
+        map->keys[index] = key;
+        map->stored++;
+    }
+    map->values[index] = value;
+}
@@ -0,0 +1,54 @@
+//
+//  pointerMap.h
+//  L1962
+//
+
+#ifndef pointerMap_h
+#define pointerMap_h
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/**
+    PointerMap Struct, an open addressing hash map from object addresses to indices
+    Used for walking heap graphs that may share or cycle (images, printing, serialization)
+ */
+typedef struct PointerMap PointerMap;
+struct PointerMap {
+    const void **keys;
+    size_t *values;
+    size_t size;
+    size_t stored;
+};
+
+/**
+    Initializes an empty PointerMap
+ @param map The map to initialize
+ */
+void pointerMapInit(PointerMap *map);
+
+/**
+    Frees the storage of a PointerMap (not the keys)
+ @param map The map to free
+ */
+void pointerMapFree(PointerMap *map);
+
+/**
+    Gets the value stored for a key
+ @param map The map to look in
+ @param key The address to look for
+ @param value Filled with the stored value if found (may be NULL)
+ @return 1 if found, 0 if not
+ */
+int pointerMapGet(const PointerMap *map, const void *key, size_t *value);
+
+/**
+    Stores a value for a key, replacing any previous value
+ @param map The map to add to
+ @param key The address to store
+ @param value The value to store for it
+ */
+void pointerMapPut(PointerMap *map, const void *key, size_t value);
+
+#endif /* pointerMap_h */
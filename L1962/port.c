@@ -0,0 +1,275 @@
+//
+//  port.c
+//      Input and output ports over files, strings and file descriptors
+//  L1962
+//
+
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "port.h"
+#include "eval.h"
+
+static _Thread_local SExpr currentOutput = { NIL }; // Console port made on first use, per thread
+
+/**
+    Makes a port (private)
+ @param input Input port, otherwise output
+ @param fd The file descriptor, -1 for a string port
+ @param ownsFd Close fd when the port is closed
+ @return The PORT SExpr
+ */
+static SExpr makePort(int input, int fd, int ownsFd) {
+    Port *port = malloc(sizeof(Port));
+    port->input = input;
+    port->open = 1;
+    port->fd = fd;
+    port->ownsFd = ownsFd;
+    port->flushEach = 0;
+    if (input) {
+        readerInit(&port->reader);
+        port->reader.fd = fd;
+    } else {
+        bufferInit(&port->buffer);
+        port->buffer.fd = fd;
+    }
+    SExpr expr;
+    expr.type = PORT;
+    expr.port = port;
+    return expr;
+}
+
+/**
+    Checks that an SExpr is an open port of the right direction (private)
+ @param expr The SExpr
+ @param input Needs an input port, otherwise output
+ @return The port
+ */
+static Port *openPort(SExpr expr, int input) {
+    check(expr.type == PORT);
+    if (!expr.port->open) {
+        fail("port is closed");
+    }
+    if (expr.port->input != input) {
+        fail(input ? "not an input port" : "not an output port");
+    }
+    return expr.port;
+}
+
+/**
+    The output port named by an optional argument, the current output port if there is none (private)
+ @param args The remaining arguments
+ @return The port
+ */
+static Port *outputPort(SExpr args) {
+    if (isNIL(args)) {
+        return openPort(evalCurrentOutputPort(NILObj), 0);
+    }
+    check(isNIL(cdr(args)));
+    return openPort(car(args), 0);
+}
+
+/**
+    Finishes an output operation (private)
+ @param port The port
+ */
+static void portWritten(Port *port) {
+    if (port->flushEach) {
+        bufferFlush(&port->buffer);
+    }
+}
+
+/**
+    The object read functions return at the end of input (private)
+ @return The eof object
+ */
+static SExpr eofObject(void) {
+    SExpr expr;
+    expr.type = END;
+    return expr;
+}
+
+/**
+    Opens a file as a port (private)
+ @param args The list holding the path
+ @param input Open for input, otherwise output
+ @return The port
+ */
+static SExpr openFile(SExpr args, int input) {
+    check(isNIL(cdr(args)));
+    SExpr path = car(args);
+    check(path.type == STRING);
+    int fd = input ? open(path.string, O_RDONLY) : open(path.string, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+    if (fd < 0) {
+        fail("can't open file: %s", path.string);
+    }
+    return makePort(input, fd, 1);
+}
+
+SExpr evalOpenInputFile(SExpr args) {
+    return openFile(args, 1);
+}
+
+SExpr evalOpenOutputFile(SExpr args) {
+    return openFile(args, 0);
+}
+
+SExpr evalOpenInputFd(SExpr args) {
+    check(isNIL(cdr(args)));
+    check(car(args).type == INT);
+    return makePort(1, (int) car(args).i, 0);
+}
+
+SExpr evalOpenOutputFd(SExpr args) {
+    check(isNIL(cdr(args)));
+    check(car(args).type == INT);
+    return makePort(0, (int) car(args).i, 0);
+}
+
+SExpr evalOpenInputString(SExpr args) {
+    check(isNIL(cdr(args)));
+    SExpr str = car(args);
+    check(str.type == STRING);
+    SExpr port = makePort(1, -1, 0);
+    readerFeed(&port.port->reader, str.string, stringLength(str));
+    readerFinish(&port.port->reader);
+    return port;
+}
+
+SExpr evalOpenOutputString(SExpr args) {
+    check(isNIL(args));
+    return makePort(0, -1, 0);
+}
+
+SExpr evalGetOutputString(SExpr args) {
+    check(isNIL(cdr(args)));
+    Port *port = openPort(car(args), 0);
+    if (port->fd >= 0 || port->buffer.file != NULL) {
+        fail("not a string port");
+    }
+    return stringToSExprLength(port->buffer.data, port->buffer.length);
+}
+
+SExpr evalClosePort(SExpr args) {
+    check(isNIL(cdr(args)));
+    check(car(args).type == PORT);
+    Port *port = car(args).port;
+    if (!port->open) {
+        return NILObj;
+    }
+    port->open = 0;
+    if (port->input) {
+        readerFree(&port->reader);
+    } else {
+        TRY_FINALLY({
+            bufferFlush(&port->buffer);
+            }, {
+                bufferFree(&port->buffer);
+                if (port->ownsFd) {
+                    close(port->fd);
+                }
+            });
+        return NILObj;
+    }
+    if (port->ownsFd) {
+        close(port->fd);
+    }
+    return NILObj;
+}
+
+SExpr evalCurrentOutputPort(SExpr args) {
+    check(isNIL(args));
+    if (isNIL(currentOutput)) {
+        currentOutput = makePort(0, -1, 0);
+        currentOutput.port->buffer.file = stdout; // Through stdio so it stays in order with the REPL's output
+        currentOutput.port->flushEach = 1;
+    }
+    return currentOutput;
+}
+
+SExpr evalRead(SExpr args) {
+    check(isNIL(cdr(args)));
+    Port *port = openPort(car(args), 1);
+    SExpr expr;
+    if (readerNext(&port->reader, &expr) != READER_OK) {
+        return eofObject();
+    }
+    return expr;
+}
+
+SExpr evalReadLine(SExpr args) {
+    check(isNIL(cdr(args)));
+    Port *port = openPort(car(args), 1);
+    static _Thread_local Buffer line = { NULL, 0, 0, NULL, -1 }; // Reused so reading a line only allocates the result
+    line.length = 0;
+    if (!readerLine(&port->reader, &line)) {
+        return eofObject();
+    }
+    return stringToSExprLength(line.data, line.length);
+}
+
+SExpr evalReadChar(SExpr args) {
+    check(isNIL(cdr(args)));
+    Port *port = openPort(car(args), 1);
+    int c = readerChar(&port->reader);
+    if (c == EOF) {
+        return eofObject();
+    }
+    return charToSExpr(c);
+}
+
+SExpr evalWrite(SExpr args) {
+    Port *port = outputPort(cdr(args));
+    writeSExprQuoted(&port->buffer, car(args));
+    portWritten(port);
+    return NILObj;
+}
+
+SExpr evalDisplay(SExpr args) {
+    Port *port = outputPort(cdr(args));
+    SExpr expr = car(args);
+    if (expr.type == STRING) {
+        bufferAppend(&port->buffer, expr.string, stringLength(expr));
+    } else if (expr.type == CHAR) {
+        bufferChar(&port->buffer, expr.c);
+    } else {
+        writeSExpr(&port->buffer, expr);
+    }
+    portWritten(port);
+    return NILObj;
+}
+
+SExpr evalNewline(SExpr args) {
+    Port *port = outputPort(args);
+    bufferChar(&port->buffer, '\n');
+    portWritten(port);
+    return NILObj;
+}
+
+SExpr evalWithOutputToString(SExpr args) {
+    check(isNIL(cdr(args)));
+    SExpr thunk = car(args);
+    SExpr saved = evalCurrentOutputPort(NILObj);
+    SExpr port = makePort(0, -1, 0);
+    currentOutput = port;
+    TRY_FINALLY({
+        callFunction(thunk, 0, NULL);
+        }, {
+            currentOutput = saved;
+        });
+    SExpr result = stringToSExprLength(port.port->buffer.data, port.port->buffer.length);
+    evalClosePort(consToSExpr(port, NILObj));
+    return result;
+}
+
+SExpr evalIsEOFObject(SExpr args) {
+    check(isNIL(cdr(args)));
+    return (car(args).type == END) ? TObj : NILObj;
+}
+
+SExpr evalIsPort(SExpr args) {
+    check(isNIL(cdr(args)));
+    return (car(args).type == PORT) ? TObj : NILObj;
+}
@@ -0,0 +1,153 @@
+//
+//  port.h
+//      Input and output ports over files, strings and file descriptors
+//  L1962
+//
+
+#ifndef port_h
+#define port_h
+
+#include "SExpr.h"
+#include "Reader.h"
+
+/**
+    Port Struct, input goes through a Reader and output through a Buffer, so every kind of port shares one buffered layer
+    A port is not locked, it should only be used by one thread at a time
+ */
+struct Port {
+    int input;      // Input port, otherwise output
+    int open;
+    int fd;         // Underlying file descriptor, -1 for string ports
+    int ownsFd;     // Close fd when the port is closed
+    int flushEach;  // Flush after every operation, for the console so it stays in order with stdio
+    Reader reader;  // For input ports
+    Buffer buffer;  // For output ports, with the fd (or stdout) as its sink
+};
+
+/**
+    open-input-file builtin, (open-input-file path)
+ @param args The list holding the path
+ @return The input port
+ */
+SExpr evalOpenInputFile(SExpr args);
+
+/**
+    open-output-file builtin, (open-output-file path), truncating any existing file
+ @param args The list holding the path
+ @return The output port
+ */
+SExpr evalOpenOutputFile(SExpr args);
+
+/**
+    open-input-fd builtin, (open-input-fd fd), the fd is left open when the port is closed
+ @param args The list holding the fd
+ @return The input port
+ */
+SExpr evalOpenInputFd(SExpr args);
+
+/**
+    open-output-fd builtin, (open-output-fd fd), the fd is left open when the port is closed
+ @param args The list holding the fd
+ @return The output port
+ */
+SExpr evalOpenOutputFd(SExpr args);
+
+/**
+    open-input-string builtin, (open-input-string str)
+ @param args The list holding the string
+ @return The input port
+ */
+SExpr evalOpenInputString(SExpr args);
+
+/**
+    open-output-string builtin, (open-output-string), collects its output for get-output-string
+ @param args NIL
+ @return The output port
+ */
+SExpr evalOpenOutputString(SExpr args);
+
+/**
+    get-output-string builtin, (get-output-string port)
+ @param args The list holding a string output port
+ @return The output so far as a string
+ */
+SExpr evalGetOutputString(SExpr args);
+
+/**
+    close-port builtin, (close-port port), flushes output and releases the port's buffers
+ @param args The list holding the port
+ @return NIL
+ */
+SExpr evalClosePort(SExpr args);
+
+/**
+    current-output-port builtin, the port display and write use by default on this thread
+ @param args NIL
+ @return The output port
+ */
+SExpr evalCurrentOutputPort(SExpr args);
+
+/**
+    read builtin, (read port), reads one SExpr
+ @param args The list holding the input port
+ @return The SExpr, or the eof object
+ */
+SExpr evalRead(SExpr args);
+
+/**
+    read-line builtin, (read-line port)
+ @param args The list holding the input port
+ @return The line without its newline, or the eof object
+ */
+SExpr evalReadLine(SExpr args);
+
+/**
+    read-char builtin, (read-char port)
+ @param args The list holding the input port
+ @return The char, or the eof object
+ */
+SExpr evalReadChar(SExpr args);
+
+/**
+    write builtin, (write expr [port]), writes expr so it reads back, strings in quotes
+ @param args The SExpr and the optional output port
+ @return NIL
+ */
+SExpr evalWrite(SExpr args);
+
+/**
+    display builtin, (display expr [port]), writes strings and chars as their raw text and everything else as printed
+ @param args The SExpr and the optional output port
+ @return NIL
+ */
+SExpr evalDisplay(SExpr args);
+
+/**
+    newline builtin, (newline [port])
+ @param args The optional output port
+ @return NIL
+ */
+SExpr evalNewline(SExpr args);
+
+/**
+    with-output-to-string builtin, (with-output-to-string thunk), calls thunk with output going to a string
+ @param args The list holding the thunk
+ @return Everything the thunk wrote to the current output port
+ */
+SExpr evalWithOutputToString(SExpr args);
+
+/**
+    eof-object? builtin
+ @param args The list holding the SExpr to check
+ @return TObj if it is the eof object read functions return at the end of input
+ */
+SExpr evalIsEOFObject(SExpr args);
+
+/**
+    port? builtin
+ @param args The list holding the SExpr to check
+ @return TObj if it is a port
+ */
+SExpr evalIsPort(SExpr args);
+
+#endif /* port_h */
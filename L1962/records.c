@@ -0,0 +1,302 @@
+//
+//  records.c
+//      Record types, defstruct and define-record-type with fields at fixed offsets
+//  L1962
+//
+
+#include <pthread.h>
+
+#include "records.h"
+#include "eval.h"
+#include "analyze.h"
+
+static Record *recordType = NULL; // The type of type descriptors, its own type
+static pthread_once_t recordTypeOnce = PTHREAD_ONCE_INIT;
+
+/**
+    Allocates a record with every field NIL (private)
+ @param type The type descriptor
+ @param count The number of fields
+ @return The record
+ */
+static Record *allocRecord(Record *type, size_t count) {
+    Record *record = malloc(sizeof(Record) + count * sizeof(SExpr));
+    record->type = type;
+    record->count = count;
+    for (size_t i = 0; i < count; i++) {
+        record->fields[i] = NILObj;
+    }
+    return record;
+}
+
+/**
+    Makes a record an SExpr (private)
+ @param record The record
+ @return The SExpr
+ */
+static SExpr recordToSExpr(Record *record) {
+    SExpr expr;
+    expr.type = RECORD;
+    expr.record = record;
+    return expr;
+}
+
+/**
+    Makes the type of type descriptors, run once (private)
+ */
+static void makeRecordType(void) {
+    recordType = allocRecord(NULL, 2);
+    recordType->type = recordType;
+    recordType->fields[0] = makeSymbol("record-type");
+    recordType->fields[1] = consToSExpr(makeSymbol("name"), consToSExpr(makeSymbol("fields"), NILObj));
+}
+
+Record *recordTypeDescriptor(void) {
+    pthread_once(&recordTypeOnce, makeRecordType);
+    return recordType;
+}
+
+/**
+    Makes a type descriptor (private)
+ @param name The type name
+ @param fieldNames The list of field names
+ @return The descriptor
+ */
+static SExpr makeTypeDescriptor(SExpr name, SExpr fieldNames) {
+    pthread_once(&recordTypeOnce, makeRecordType);
+    Record *type = allocRecord(recordType, 2);
+    type->fields[0] = name;
+    type->fields[1] = fieldNames;
+    return recordToSExpr(type);
+}
+
+/**
+    Checks that an SExpr is a type descriptor (private)
+ @param expr The SExpr
+ @return The descriptor
+ */
+static Record *checkTypeDescriptor(SExpr expr) {
+    pthread_once(&recordTypeOnce, makeRecordType);
+    if (expr.type != RECORD || expr.record->type != recordType) {
+        fail("Expected a record type, got %s", SExprName(expr.type));
+    }
+    return expr.record;
+}
+
+/**
+    Checks that an SExpr is a record of a type (private)
+ @param expr The SExpr
+ @param type The type descriptor
+ @param function The name of the function checking, for the error
+ @return The record
+ */
+static Record *checkRecord(SExpr expr, Record *type, const char *function) {
+    if (__builtin_expect(expr.type != RECORD || expr.record->type != type, 0)) {
+        fail("%s: expected a %s, got %s", function, type->fields[0].symbol, (expr.type == RECORD) ? expr.record->type->fields[0].symbol : SExprName(expr.type));
+    }
+    return expr.record;
+}
+
+/**
+    The offset of a field (private)
+ @param fieldNames The list of field names
+ @param name The field
+ @return The index
+ */
+static size_t fieldIndex(SExpr fieldNames, SExpr name) {
+    size_t index = 0;
+    for (SExpr current = fieldNames; isCONS(current); current = uncheckedCdr(current), index++) {
+        if (uncheckedCar(current).symbol == name.symbol) {
+            return index;
+        }
+    }
+    fail("Record has no field %s", isSYMBOL(name) ? name.symbol : SExprName(name.type));
+}
+
+// Specialized code, the parameters are read straight out of the environment runLambdaCall built
+
+/**
+    Constructor, value is the type descriptor and params the field index of each parameter in environment order (private)
+ */
+static SExpr runConstruct(Node *node, SExpr env) {
+    Record *type = node->value.record;
+    Record *record = allocRecord(type, node->index);
+    for (SExpr index = node->params; isCONS(index); index = uncheckedCdr(index), env = uncheckedCdr(env)) {
+        record->fields[uncheckedCar(index).i] = uncheckedCdr(uncheckedCar(env));
+    }
+    return recordToSExpr(record);
+}
+
+/**
+    Predicate, value is the type descriptor (private)
+ */
+static SExpr runPredicate(Node *node, SExpr env) {
+    SExpr expr = uncheckedCdr(uncheckedCar(env));
+    return (expr.type == RECORD && expr.record->type == node->value.record) ? TObj : NILObj;
+}
+
+/**
+    Accessor, value is the type descriptor, index the field and params the accessor's name (private)
+ */
+static SExpr runAccessor(Node *node, SExpr env) {
+    Record *record = checkRecord(uncheckedCdr(uncheckedCar(env)), node->value.record, node->params.symbol);
+    return record->fields[node->index];
+}
+
+/**
+    Modifier, value is the type descriptor, index the field and params the modifier's name (private)
+ */
+static SExpr runModifier(Node *node, SExpr env) {
+    SExpr value = uncheckedCdr(uncheckedCar(env));
+    Record *record = checkRecord(uncheckedCdr(uncheckedCar(uncheckedCdr(env))), node->value.record, node->params.symbol);
+    record->fields[node->index] = value;
+    return NILObj;
+}
+
+/**
+    Defines a global lambda with specialized code (private)
+ @param name The name
+ @param params The parameters
+ @param body The single expression the code is equivalent to
+ @param code The code
+ */
+static void defineFunction(SExpr name, SExpr params, SExpr body, Node *code) {
+    SExpr lambda = lambdaToSExpr(params, consToSExpr(body, NILObj), NILObj);
+    lambda.lambda->code = code;
+    evalSETBang(name, lambda, NILObj);
+}
+
+/**
+    Checks if a list holds a symbol (private)
+ @param list The list
+ @param symbol The symbol
+ @return 1 if it does
+ */
+static int containsSymbol(SExpr list, SExpr symbol) {
+    for (; isCONS(list); list = uncheckedCdr(list)) {
+        if (identical(uncheckedCar(list), symbol)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+SExpr defineRecordType(SExpr name, SExpr constructor, SExpr predicate, SExpr fields, int bindName) {
+    check(isSYMBOL(name));
+    SExpr fieldNames = NILObj;
+    SExpr last = NILObj;
+    size_t count = 0;
+    for (SExpr current = fields; isCONS(current); current = uncheckedCdr(current), count++) {
+        SExpr field = car(uncheckedCar(current));
+        check(isSYMBOL(field));
+        if (containsSymbol(fieldNames, field)) {
+            fail("Record %s has the field %s twice", name.symbol, field.symbol);
+        }
+        SExpr cell = consToSExpr(field, NILObj);
+        if (isNIL(last)) {
+            fieldNames = cell;
+        } else {
+            last.cons->cdr = cell;
+        }
+        last = cell;
+    }
+    SExpr type = makeTypeDescriptor(name, fieldNames);
+    SExpr record = makeSymbol("record");
+    SExpr value = makeSymbol("value");
+    if (bindName) {
+        evalSETBang(name, type, NILObj);
+    }
+
+    if (isCONS(constructor)) {
+        SExpr params = cdr(constructor);
+        SExpr indices = NILObj; // In environment order, the last parameter first
+        for (SExpr param = params; isCONS(param); param = uncheckedCdr(param)) {
+            indices = consToSExpr(intToSExpr((int64_t) fieldIndex(fieldNames, uncheckedCar(param))), indices);
+        }
+        SExpr *values = malloc((count + 1) * sizeof(SExpr));
+        values[0] = type;
+        size_t i = 1;
+        for (SExpr field = fieldNames; isCONS(field); field = uncheckedCdr(field), i++) {
+            values[i] = containsSymbol(params, uncheckedCar(field)) ? uncheckedCar(field) : NILObj;
+        }
+        SExpr body = consToSExpr(makeSymbol("make-record"), arrayToList(count + 1, values));
+        free(values);
+        Node *code = makeNode(runConstruct, 0);
+        code->value = type;
+        code->params = indices;
+        code->index = count;
+        defineFunction(car(constructor), params, body, code);
+    }
+
+    if (isSYMBOL(predicate)) {
+        Node *code = makeNode(runPredicate, 0);
+        code->value = type;
+        SExpr items[3] = { makeSymbol("record?"), record, type };
+        defineFunction(predicate, consToSExpr(record, NILObj), arrayToList(3, items), code);
+    }
+
+    size_t index = 0;
+    for (SExpr current = fields; isCONS(current); current = uncheckedCdr(current), index++) {
+        SExpr spec = uncheckedCar(current);
+        SExpr rest = cdr(spec);
+        SExpr accessor = isCONS(rest) ? uncheckedCar(rest) : NILObj;
+        SExpr modifier = (isCONS(rest) && isCONS(uncheckedCdr(rest))) ? uncheckedCar(uncheckedCdr(rest)) : NILObj;
+        if (isSYMBOL(accessor)) {
+            Node *code = makeNode(runAccessor, 0);
+            code->value = type;
+            code->index = index;
+            code->params = accessor;
+            SExpr items[4] = { makeSymbol("record-ref"), record, type, intToSExpr((int64_t) index) };
+            defineFunction(accessor, consToSExpr(record, NILObj), arrayToList(4, items), code);
+        }
+        if (isSYMBOL(modifier)) {
+            Node *code = makeNode(runModifier, 0);
+            code->value = type;
+            code->index = index;
+            code->params = modifier;
+            SExpr items[5] = { makeSymbol("record-set!"), record, type, intToSExpr((int64_t) index), value };
+            defineFunction(modifier, consToSExpr(record, consToSExpr(value, NILObj)), arrayToList(5, items), code);
+        }
+    }
+    return name;
+}
+
+SExpr evalMakeRecord(int argc, SExpr *argv) {
+    check(argc >= 1);
+    Record *type = checkTypeDescriptor(argv[0]);
+    size_t count = (size_t) length(type->fields[1]).i;
+    if ((size_t) argc - 1 != count) {
+        fail("make-record: %s has %zu fields, got %d values", type->fields[0].symbol, count, argc - 1);
+    }
+    Record *record = allocRecord(type, count);
+    for (size_t i = 0; i < count; i++) {
+        record->fields[i] = argv[i + 1];
+    }
+    return recordToSExpr(record);
+}
+
+SExpr evalIsRecord(int argc, SExpr *argv) {
+    check(argc == 1 || argc == 2);
+    if (argv[0].type != RECORD) {
+        return NILObj;
+    }
+    if (argc == 1) {
+        return TObj;
+    }
+    return (argv[0].record->type == checkTypeDescriptor(argv[1])) ? TObj : NILObj;
+}
+
+SExpr evalRecordRef(int argc, SExpr *argv) {
+    check(argc == 3);
+    Record *record = checkRecord(argv[0], checkTypeDescriptor(argv[1]), "record-ref");
+    check(argv[2].type == INT && argv[2].i >= 0 && (size_t) argv[2].i < record->count);
+    return record->fields[argv[2].i];
+}
+
+SExpr evalRecordSet(int argc, SExpr *argv) {
+    check(argc == 4);
+    Record *record = checkRecord(argv[0], checkTypeDescriptor(argv[1]), "record-set!");
+    check(argv[2].type == INT && argv[2].i >= 0 && (size_t) argv[2].i < record->count);
+    record->fields[argv[2].i] = argv[3];
+    return NILObj;
+}
@@ -0,0 +1,62 @@
+//
+//  records.h
+//      Record types, defstruct and define-record-type with fields at fixed offsets
+//  L1962
+//
+
+#ifndef records_h
+#define records_h
+
+#include "SExpr.h"
+
+/**
+    Makes a new record type and defines its constructor, predicate, accessors and modifiers as globals
+    The functions are lambdas whose code reads the field at its offset directly, the body is the equivalent generic call
+ @param name The type name
+ @param constructor (name fields...) with the fields it takes in order, the rest start as NIL, or NIL for none
+ @param predicate The predicate name, or NIL for none
+ @param fields The list of (field [accessor [modifier]])
+ @param bindName Also bind the type name to the type descriptor, as define-record-type does
+ @return The type name
+ */
+SExpr defineRecordType(SExpr name, SExpr constructor, SExpr predicate, SExpr fields, int bindName);
+
+/**
+    The type of type descriptors, shared by every descriptor and its own type
+ @return The descriptor
+ */
+Record *recordTypeDescriptor(void);
+
+/**
+    make-record builtin, (make-record type values...)
+ @param argc The number of arguments, 1 + the number of fields
+ @param argv The type descriptor followed by every field's value in order
+ @return The record
+ */
+SExpr evalMakeRecord(int argc, SExpr *argv);
+
+/**
+    record? builtin, (record? value [type])
+ @param argc The number of arguments, 1 or 2
+ @param argv The value and the optional type descriptor
+ @return true if the value is a record, of that type if one was given
+ */
+SExpr evalIsRecord(int argc, SExpr *argv);
+
+/**
+    record-ref builtin, (record-ref record type index)
+ @param argc The number of arguments, 3
+ @param argv The record, the type it must be and the field index
+ @return The field
+ */
+SExpr evalRecordRef(int argc, SExpr *argv);
+
+/**
+    record-set! builtin, (record-set! record type index value)
+ @param argc The number of arguments, 4
+ @param argv The record, the type it must be, the field index and the value
+ @return NIL
+ */
+SExpr evalRecordSet(int argc, SExpr *argv);
+
+#endif /* records_h */
@@ -0,0 +1,203 @@
+//
+//  stringSearch.c
+//      Native string scanning, searching, splitting, joining and trimming on the string bytes themselves
+//  L1962
+//
+
+#define _GNU_SOURCE // memmem
+
+#include <string.h>
+#include <ctype.h>
+
+#include "stringSearch.h"
+
+/**
+    The optional start index of a search (private)
+ @param argc The number of arguments
+ @param argv The arguments, the string first
+ @param position The position of the start argument
+ @return The start, 0 when it is not given
+ */
+static size_t searchStart(int argc, SExpr *argv, int position) {
+    if (argc <= position) {
+        return 0;
+    }
+    SExpr start = argv[position];
+    if (start.type != INT || start.i < 0 || (uint64_t) start.i > stringLength(argv[0])) {
+        fail("Start index out of range");
+    }
+    return (size_t) start.i;
+}
+
+/**
+    Finds a run of bytes, memchr for a single byte and memmem (two-way in glibc) otherwise (private)
+ @param haystack The bytes to search
+ @param length The number of bytes to search
+ @param needle The bytes to look for
+ @param needleLength The number of bytes to look for, at least 1
+ @return The first match, NULL if there is none
+ */
+static const char *findBytes(const char *haystack, size_t length, const char *needle, size_t needleLength) {
+    if (needleLength == 1) {
+        return memchr(haystack, needle[0], length);
+    }
+    return memmem(haystack, length, needle, needleLength);
+}
+
+/**
+    Adds a field to the end of a list being built (private)
+ @param head The list, updated when it was empty
+ @param last The last cons, updated
+ @param bytes The bytes of the field
+ @param length The number of bytes
+ */
+static void addField(SExpr *head, SExpr *last, const char *bytes, size_t length) {
+    SExpr cell = consToSExpr(stringToSExprLength(bytes, length), NILObj);
+    if (isNIL(*last)) {
+        *head = cell;
+    } else {
+        last->cons->cdr = cell;
+    }
+    *last = cell;
+}
+
+SExpr evalStringIndex(int argc, SExpr *argv) {
+    check(argc == 2 || argc == 3);
+    check(argv[0].type == STRING && argv[1].type == CHAR);
+    size_t start = searchStart(argc, argv, 2);
+    const char *found = memchr(argv[0].string + start, argv[1].c, stringLength(argv[0]) - start);
+    return (found == NULL) ? NILObj : intToSExpr((int64_t) (found - argv[0].string));
+}
+
+SExpr evalStringSearch(int argc, SExpr *argv) {
+    check(argc == 2 || argc == 3);
+    check(argv[0].type == STRING && argv[1].type == STRING);
+    size_t start = searchStart(argc, argv, 2);
+    size_t patternLength = stringLength(argv[1]);
+    if (patternLength == 0) {
+        return intToSExpr((int64_t) start);
+    }
+    const char *found = findBytes(argv[0].string + start, stringLength(argv[0]) - start, argv[1].string, patternLength);
+    return (found == NULL) ? NILObj : intToSExpr((int64_t) (found - argv[0].string));
+}
+
+SExpr evalStringSplit(int argc, SExpr *argv) {
+    check(argc == 1 || argc == 2);
+    check(argv[0].type == STRING);
+    const char *string = argv[0].string;
+    size_t length = stringLength(argv[0]);
+    SExpr head = NILObj;
+    SExpr last = NILObj;
+    if (argc == 1) { // Runs of whitespace, no empty fields
+        size_t i = 0;
+        while (i < length) {
+            while (i < length && isspace((unsigned char) string[i])) {
+                i++;
+            }
+            size_t start = i;
+            while (i < length && !isspace((unsigned char) string[i])) {
+                i++;
+            }
+            if (i > start) {
+                addField(&head, &last, string + start, i - start);
+            }
+        }
+        return head;
+    }
+    const char *delimiter;
+    size_t delimiterLength;
+    if (argv[1].type == CHAR) {
+        delimiter = &argv[1].c;
+        delimiterLength = 1;
+    } else if (argv[1].type == STRING && stringLength(argv[1]) > 0) {
+        delimiter = argv[1].string;
+        delimiterLength = stringLength(argv[1]);
+    } else {
+        fail("string-split: the delimiter must be a char or a non-empty string");
+    }
+    size_t start = 0;
+    for (;;) {
+        const char *found = findBytes(string + start, length - start, delimiter, delimiterLength);
+        if (found == NULL) {
+            addField(&head, &last, string + start, length - start);
+            return head;
+        }
+        addField(&head, &last, string + start, (size_t) (found - (string + start)));
+        start = (size_t) (found - string) + delimiterLength;
+    }
+}
+
+SExpr evalStringJoin(int argc, SExpr *argv) {
+    check(argc == 1 || argc == 2);
+    check(isLIST(argv[0]));
+    const char *delimiter = " ";
+    size_t delimiterLength = 1;
+    if (argc == 2) {
+        check(argv[1].type == STRING);
+        delimiter = argv[1].string;
+        delimiterLength = stringLength(argv[1]);
+    }
+    size_t length = 0;
+    size_t count = 0;
+    SExpr current;
+    for (current = argv[0]; isCONS(current); current = uncheckedCdr(current), count++) {
+        if (uncheckedCar(current).type != STRING) {
+            fail("string-join: element %zu is %s, not a string", count, SExprName(uncheckedCar(current).type));
+        }
+        length += stringLength(uncheckedCar(current));
+    }
+    check(isNIL(current));
+    if (count > 1) {
+        length += (count - 1) * delimiterLength;
+    }
+    char *joined = allocString(length); // Sized once, each piece copied once
+    size_t offset = 0;
+    for (current = argv[0]; isCONS(current); current = uncheckedCdr(current)) {
+        if (current.cons != argv[0].cons) { // Between pieces
+            memcpy(joined + offset, delimiter, delimiterLength);
+            offset += delimiterLength;
+        }
+        SExpr piece = uncheckedCar(current);
+        memcpy(joined + offset, piece.string, stringLength(piece));
+        offset += stringLength(piece);
+    }
+    SExpr string;
+    string.type = STRING;
+    string.string = joined;
+    return string;
+}
+
+/**
+    Trims whitespace from either end of a string (private)
+ @param argc The number of arguments, 1
+ @param argv The string
+ @param left Trim the start
+ @param right Trim the end
+ @return The trimmed string
+ */
+static SExpr trim(int argc, SExpr *argv, int left, int right) {
+    check(argc == 1);
+    check(argv[0].type == STRING);
+    const char *string = argv[0].string;
+    size_t start = 0;
+    size_t end = stringLength(argv[0]);
+    while (left && start < end && isspace((unsigned char) string[start])) {
+        start++;
+    }
+    while (right && end > start && isspace((unsigned char) string[end - 1])) {
+        end--;
+    }
+    return stringToSExprLength(string + start, end - start);
+}
+
+SExpr evalStringTrim(int argc, SExpr *argv) {
+    return trim(argc, argv, 1, 1);
+}
+
+SExpr evalStringTrimLeft(int argc, SExpr *argv) {
+    return trim(argc, argv, 1, 0);
+}
+
+SExpr evalStringTrimRight(int argc, SExpr *argv) {
+    return trim(argc, argv, 0, 1);
+}
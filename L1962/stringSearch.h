@@ -0,0 +1,69 @@
+//
+//  stringSearch.h
+//      Native string scanning, searching, splitting, joining and trimming on the string bytes themselves
+//  L1962
+//
+
+#ifndef stringSearch_h
+#define stringSearch_h
+
+#include "SExpr.h"
+
+/**
+    string-index builtin, (string-index string char [start])
+ @param argc The number of arguments, 2 or 3
+ @param argv The string, the char and the optional index to start from
+ @return The index of the first match as an INT, NIL if there is none
+ */
+SExpr evalStringIndex(int argc, SExpr *argv);
+
+/**
+    string-search builtin, (string-search string pattern [start])
+ @param argc The number of arguments, 2 or 3
+ @param argv The string, the pattern and the optional index to start from
+ @return The index of the first match as an INT, NIL if there is none
+ */
+SExpr evalStringSearch(int argc, SExpr *argv);
+
+/**
+    string-split builtin, (string-split string [delimiter])
+    With a char or string delimiter every field is kept, empty ones included; without one the string is split on runs of whitespace
+ @param argc The number of arguments, 1 or 2
+ @param argv The string and the optional delimiter
+ @return The list of fields
+ */
+SExpr evalStringSplit(int argc, SExpr *argv);
+
+/**
+    string-join builtin, (string-join strings [delimiter]), " " when no delimiter is given
+ @param argc The number of arguments, 1 or 2
+ @param argv The list of strings and the optional delimiter string
+ @return The joined string
+ */
+SExpr evalStringJoin(int argc, SExpr *argv);
+
+/**
+    string-trim builtin, (string-trim string), whitespace is removed from both ends
+ @param argc The number of arguments, 1
+ @param argv The string
+ @return The trimmed string
+ */
+SExpr evalStringTrim(int argc, SExpr *argv);
+
+/**
+    string-trim-left builtin, (string-trim-left string)
+ @param argc The number of arguments, 1
+ @param argv The string
+ @return The string without leading whitespace
+ */
+SExpr evalStringTrimLeft(int argc, SExpr *argv);
+
+/**
+    string-trim-right builtin, (string-trim-right string)
+ @param argc The number of arguments, 1
+ @param argv The string
+ @return The string without trailing whitespace
+ */
+SExpr evalStringTrimRight(int argc, SExpr *argv);
+
+#endif /* stringSearch_h */
@@ -8,20 +8,43 @@
 #include <string.h>
 #include <stdio.h>
 #include <ctype.h>
+#include <pthread.h>
 
 #include "struniq.h"
 
+static pthread_rwlock_t symbolLock = PTHREAD_RWLOCK_INITIALIZER; // The hashSet is shared by every thread
+
+/**
+    Looks a canonical string up in the hashSet and adds it if needed, under the symbol lock (private)
+ @param s The canonical (lowercase) string
+ @param copy Whether s must be strdup'ed before it is added
+ @return The unique string
+ */
+static const char *intern(const char *s, int copy) {
+    pthread_rwlock_rdlock(&symbolLock); // Common case: already seen, readers run in parallel
+    const char *out = get(s);
+    pthread_rwlock_unlock(&symbolLock);
+    if (out != NULL) {
+        return out;
+    }
+    pthread_rwlock_wrlock(&symbolLock);
+    out = get(s); // Another thread may have added it in the meantime
+    if (out == NULL) {
+        out = add(copy ? strdup(s) : s);
+    }
+    pthread_rwlock_unlock(&symbolLock);
+    return out;
+}
+
 const char *struniq(const char *s) {
     char buf[(strlen(s) + 1)];
     buf[strlen(s)] = 0;
     for(int i = 0; s[i]; i++) {
         buf[i] = tolower(s[i]);
     }
-    const char *out = get(buf);
-    if (out == NULL) { // Not already seen (e.g. unique)
-        out = add(strdup(buf));
-        return out;
-    } else { // In map // Seen alreay (pull from list)
-        return out;
-    }
+    return intern(buf, 1);
+}
+
+const char *struniqNoCopy(const char *s) {
+    return intern(s, 0);
 }
@@ -17,4 +17,11 @@
  */
 const char *struniq(const char *s);
 
+/**
+    Interns a string that is already in canonical (lowercase) form without copying it
+ @param s  A pointer to a lowercase string that outlives the hashSet (e.g. inside a mapped image)
+ @return s if unique or the pointer to a known string if a duplicate
+ */
+const char *struniqNoCopy(const char *s);
+
 #endif /* struniq_h */
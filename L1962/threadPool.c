@@ -0,0 +1,223 @@
+//
+//  threadPool.c
+//      Work-stealing pool of worker threads shared by every evaluator
+//  L1962
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "threadPool.h"
+
+/**
+    Deque Struct, a growable ring of tasks
+    The owner pushes and pops at the tail, thieves steal from the head
+ */
+typedef struct Deque Deque;
+struct Deque {
+    pthread_mutex_t lock;
+    Task **tasks;
+    size_t head;
+    size_t tail;
+    size_t capacity;
+};
+
+static pthread_mutex_t poolLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t poolWork = PTHREAD_COND_INITIALIZER; // Signaled when a task is submitted, broadcast when one finishes while threads wait
+static atomic_int started = 0;
+static int workerCount = 0; // 0 until configured, then fixed once started
+static Deque *deques = NULL; // deques[0] is shared by non-worker threads, deques[i] belongs to worker i
+static atomic_int pending = 0; // Tasks sitting in deques, counted before they are pushed so it never goes negative
+static atomic_int waiters = 0; // Threads blocked in taskWait
+
+static _Thread_local int workerIndex = 0; // 0 for threads that are not pool workers
+
+/**
+    Pushes a task at the tail of a deque (private)
+ @param deque The deque
+ @param task The task
+ */
+static void dequePush(Deque *deque, Task *task) {
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail - deque->head == deque->capacity) {
+        size_t capacity = deque->capacity * 2;
+        Task **tasks = malloc(capacity * sizeof(Task *));
+        for (size_t i = deque->head; i < deque->tail; i++) {
+            tasks[i % capacity] = deque->tasks[i % deque->capacity];
+        }
+        free(deque->tasks);
+        deque->tasks = tasks;
+        deque->capacity = capacity;
+    }
+    deque->tasks[deque->tail % deque->capacity] = task;
+    deque->tail++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+/**
+    Takes a task from a deque (private)
+ @param deque The deque
+ @param steal 1 to take the oldest task from the head, 0 to take the newest from the tail
+ @return The task or NULL if empty
+ */
+static Task *dequeTake(Deque *deque, int steal) {
+    Task *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail != deque->head) {
+        if (steal) {
+            task = deque->tasks[deque->head % deque->capacity];
+            deque->head++;
+        } else {
+            deque->tail--;
+            task = deque->tasks[deque->tail % deque->capacity];
+        }
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+/**
+    Finds the next task for this thread: its own deque first, then steals from the others (private)
+ @return The task or NULL if there is no pending work
+ */
+static Task *findTask(void) {
+    if (atomic_load(&pending) == 0) {
+        return NULL;
+    }
+    Task *task = dequeTake(&deques[workerIndex], workerIndex != 0 ? 0 : 1);
+    for (int i = 1; task == NULL && i <= workerCount; i++) {
+        task = dequeTake(&deques[(workerIndex + i) % (workerCount + 1)], 1);
+    }
+    if (task != NULL) {
+        atomic_fetch_sub(&pending, 1);
+    }
+    return task;
+}
+
+/**
+    Runs a task and marks it done (private)
+ @param task The task
+ */
+static void runTask(Task *task) {
+    task->run(task);
+    atomic_store(&task->done, 1);
+    if (atomic_load(&waiters) > 0) {
+        pthread_mutex_lock(&poolLock);
+        pthread_cond_broadcast(&poolWork);
+        pthread_mutex_unlock(&poolLock);
+    }
+}
+
+/**
+    Worker thread loop, runs tasks and sleeps when there are none (private)
+ @param arg The worker index
+ @return NULL
+ */
+static void *workerLoop(void *arg) {
+    workerIndex = (int) (intptr_t) arg;
+    while (1) {
+        Task *task = findTask();
+        if (task != NULL) {
+            runTask(task);
+        } else {
+            pthread_mutex_lock(&poolLock);
+            while (atomic_load(&pending) == 0) {
+                pthread_cond_wait(&poolWork, &poolLock);
+            }
+            pthread_mutex_unlock(&poolLock);
+        }
+    }
+    return NULL;
+}
+
+/**
+    Starts the worker threads if they are not already running (private)
+ */
+static void poolStart(void) {
+    pthread_mutex_lock(&poolLock);
+    if (!started) {
+        if (workerCount <= 0) {
+            long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+            workerCount = (cpus > 1) ? (int) cpus - 1 : 1; // The waiting thread is the last worker
+        }
+        deques = malloc((workerCount + 1) * sizeof(Deque));
+        for (int i = 0; i <= workerCount; i++) {
+            pthread_mutex_init(&deques[i].lock, NULL);
+            deques[i].capacity = 64;
+            deques[i].tasks = malloc(deques[i].capacity * sizeof(Task *));
+            deques[i].head = 0;
+            deques[i].tail = 0;
+        }
+        for (int i = 1; i <= workerCount; i++) {
+            pthread_t thread;
+            if (pthread_create(&thread, NULL, workerLoop, (void *) (intptr_t) i) == 0) {
+                pthread_detach(thread);
+            } else {
+                fprintf(stderr, "can't start pool worker %d\n", i); // Waiting threads still run the tasks
+            }
+        }
+        started = 1;
+    }
+    pthread_mutex_unlock(&poolLock);
+}
+
+int poolSetWorkers(int count) {
+    int set = 0;
+    pthread_mutex_lock(&poolLock);
+    if (!started && count > 0) {
+        workerCount = count;
+        set = 1;
+    }
+    pthread_mutex_unlock(&poolLock);
+    return set;
+}
+
+int poolWorkers(void) {
+    pthread_mutex_lock(&poolLock);
+    int count = workerCount;
+    pthread_mutex_unlock(&poolLock);
+    if (count <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        count = (cpus > 1) ? (int) cpus - 1 : 1;
+    }
+    return count;
+}
+
+void taskInit(Task *task, void (*run)(Task *task)) {
+    task->run = run;
+    atomic_init(&task->done, 0);
+}
+
+void taskSubmit(Task *task) {
+    if (!started) {
+        poolStart();
+    }
+    atomic_fetch_add(&pending, 1);
+    dequePush(&deques[workerIndex], task);
+    pthread_mutex_lock(&poolLock);
+    pthread_cond_signal(&poolWork);
+    pthread_mutex_unlock(&poolLock);
+}
+
+void taskWait(Task *task) {
+    while (!atomic_load(&task->done)) {
+        Task *other = findTask();
+        if (other != NULL) {
+            runTask(other); // Help instead of blocking
+        } else {
+            pthread_mutex_lock(&poolLock);
+            atomic_fetch_add(&waiters, 1);
+            while (!atomic_load(&task->done) && atomic_load(&pending) == 0) {
+                pthread_cond_wait(&poolWork, &poolLock);
+            }
+            atomic_fetch_sub(&waiters, 1);
+            pthread_mutex_unlock(&poolLock);
+        }
+    }
+}
+
+int taskDone(Task *task) {
+    return atomic_load(&task->done);
+}
@@ -0,0 +1,62 @@
+//
+//  threadPool.h
+//      Work-stealing pool of worker threads shared by every evaluator
+//  L1962
+//
+
+#ifndef threadPool_h
+#define threadPool_h
+
+#include <stdatomic.h>
+
+/**
+    Task Struct, a unit of work for the pool
+    Embed it as the first member of a larger struct to pass data to run
+ */
+typedef struct Task Task;
+struct Task {
+    void (*run)(Task *task); // Must not fail out, catch failures and record them in the task
+    atomic_int done;
+};
+
+/**
+    Sets the number of worker threads, only allowed before the pool has started
+ @param count The number of workers (the threads waiting on tasks help as well)
+ @return 1 if set, 0 if the pool is already running
+ */
+int poolSetWorkers(int count);
+
+/**
+    The number of worker threads the pool runs (or will run)
+ @return The worker count
+ */
+int poolWorkers(void);
+
+/**
+    Prepares a task to be submitted
+ @param task The task
+ @param run The function that performs the task
+ */
+void taskInit(Task *task, void (*run)(Task *task));
+
+/**
+    Submits a task, workers push onto their own deque and other threads onto the shared one
+    Starts the pool on first use
+ @param task The task to run, must stay alive until it is done
+ */
+void taskSubmit(Task *task);
+
+/**
+    Waits until a task is done, running or stealing other pending tasks in the meantime and sleeping when there are none
+ @param task The task to wait for
+ */
+void taskWait(Task *task);
+
+/**
+    Checks whether a task is done without waiting
+ @param task The task
+ @return 1 if done, 0 if not
+ */
+int taskDone(Task *task);
+
+#endif /* threadPool_h */
@@ -11,15 +11,17 @@
 
 #include "try.h"
 
-FailureHandler *failureHandler = NULL;
+_Thread_local FailureHandler *failureHandler = NULL;
 
-Failure currentFailure = { NULL };
+_Thread_local Failure currentFailure = { NULL };
+
+static _Thread_local char failureBuffer[BUFSIZ]; // Preallocated storage for formatted failure messages
 
 noreturn void failInternal() {
     assert(currentFailure.message != NULL);
     FailureHandler *handler = failureHandler;
     failureHandler = handler->outer;
-    longjmp(handler->target, 1);
+    siglongjmp(handler->target, 1);
 }    
 
 noreturn void failNoCopy(Failure failure) {
@@ -35,15 +37,23 @@ noreturn void failNoCopy(Failure failure) {
     failInternal();
 }
 
-noreturn void fail(const char *fmt, ...) {
+noreturn void failMessage(const char *message) {
     Failure failure;
+    failure.message = message;
+    failNoCopy(failure);
+}
+
+noreturn void fail(const char *fmt, ...) {
+    if (strchr(fmt, '%') == NULL) { // Nothing to fill in, skip the formatting
+        failMessage(fmt);
+    }
+    char scratch[BUFSIZ]; // The fill-ins may point into failureBuffer when a failure is rethrown, so never format over them
     va_list ap;
     va_start(ap, fmt);
-    char buf[BUFSIZ];
-    vsnprintf(buf, BUFSIZ, fmt, ap);
+    vsnprintf(scratch, BUFSIZ, fmt, ap);
     va_end(ap);
-    failure.message = strdup(buf);
-    failNoCopy(failure);
+    memcpy(failureBuffer, scratch, strlen(scratch) + 1);
+    failMessage(failureBuffer);
 }
 
 void printHandlerStack() {
@@ -15,23 +15,26 @@
 
 /**
 	FailureHandler Struct, handles failures
-	Contains a jmp_buf and a pointer to the outer (next) FailureHandler
+	Contains a sigjmp_buf and a pointer to the outer (next) FailureHandler
+	The buffer is filled with sigsetjmp(target, 0) so entering a handler never saves the signal mask
 */
 typedef struct FailureHandler FailureHandler;
 struct FailureHandler {
-    jmp_buf target;
+    sigjmp_buf target;
     FailureHandler *outer;
 };
-extern FailureHandler *failureHandler; // General FailureHandler
+extern _Thread_local FailureHandler *failureHandler; // General FailureHandler, one chain per thread
 
 /**
 	Failure Struct, wrapper for the message
+	The message is either a string literal or points into the preallocated failureBuffer,
+	so it is only valid until the next failure is raised
 */
 typedef struct Failure Failure;
 struct Failure{
-    char *message;
+    const char *message;
 };
-extern Failure currentFailure; // currentFailure to handle
+extern _Thread_local Failure currentFailure; // currentFailure to handle, one per thread
 
 
 /**
@@ -51,7 +54,16 @@ noreturn void failInternal(void);
 noreturn void failNoCopy(Failure failure);
 
 /**
-	Creates a failure with the given message and strdups it
+	Creates a failure with the given constant message, no formatting or allocation is done
+	Calls failNoCopy
+@param message The message, must outlive the failure (normally a string literal)
+*/
+noreturn void failMessage(const char *message);
+
+/**
+	Creates a failure with the given message
+	Messages without fill-ins are used as is, otherwise they are formatted into the preallocated failure buffer
+	The fill-ins may be an earlier failure's message, fail("%s", e.message) is safe
 	Calls failNoCopy
 @param fmt The message to copy (with sprintf style fill-ins)
 */
@@ -67,7 +79,7 @@ noreturn void fail(const char *fmt, ...);
         assert(failureHandler != &__handler); \
         __handler.outer = failureHandler; \
         failureHandler = &__handler; \
-        if (setjmp(__handler.target) == 0) { \
+        if (sigsetjmp(__handler.target, 0) == 0) { \
             { body; } \
             failureHandler = __handler.outer; \
         } else { \
@@ -85,7 +97,7 @@ noreturn void fail(const char *fmt, ...);
         __handler.outer = failureHandler; \
         failureHandler = &__handler; \
         int __failed = 0; \
-        if (setjmp(__handler.target) == 0) { \
+        if (sigsetjmp(__handler.target, 0) == 0) { \
             { body; } \
             failureHandler = __handler.outer; \
         } else { __failed = 1; } \
@@ -110,8 +122,8 @@ void printHandlerStack(void);
 #define TOSTRING(x) STRINGIFY(x)
 #define check(e) \
     do { \
-        if (!(e)) { \
-            fail(__FILE__ ":" TOSTRING(__LINE__) \
+        if (__builtin_expect(!(e), 0)) { \
+            failMessage(__FILE__ ":" TOSTRING(__LINE__) \
                  ": check failed: " #e); \
         } \
     } while (0)
@@ -0,0 +1,658 @@
+//
+//  vectors.c
+//      Homogeneous numeric vectors, f64vector and s64vector, with data-parallel kernels for the bulk operations
+//  L1962
+//
+
+#include <string.h>
+
+#include "vectors.h"
+
+extern inline int isVector(SExpr expr);
+
+// The kernels use GCC vector extensions, 4 lanes of 64 bits: AVX registers when built with -mavx, SSE2 pairs on plain
+// x86-64 and NEON on ARM. Unsigned lanes keep s64 arithmetic wrapping, the loops finish the last few elements one at a time
+
+#define LANES 4
+
+typedef double f64x4 __attribute__((vector_size(LANES * sizeof(double))));
+typedef int64_t s64x4 __attribute__((vector_size(LANES * sizeof(int64_t))));
+typedef uint64_t u64x4 __attribute__((vector_size(LANES * sizeof(uint64_t))));
+
+#pragma GCC diagnostic ignored "-Wpsabi" // Vectors are only passed to static inline helpers, never across an ABI boundary
+
+/**
+    Loads 4 doubles, unaligned (private)
+ */
+static inline f64x4 loadF64(const double *p) {
+    f64x4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+    Loads 4 signed integers, unaligned (private)
+ */
+static inline s64x4 loadS64(const int64_t *p) {
+    s64x4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+    Loads 4 unsigned integers, unaligned (private)
+ */
+static inline u64x4 loadU64(const uint64_t *p) {
+    u64x4 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/**
+    Stores 4 doubles, unaligned (private)
+ */
+static inline void storeF64(double *p, f64x4 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+/**
+    Stores 4 signed integers, unaligned (private)
+ */
+static inline void storeS64(int64_t *p, s64x4 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+/**
+    Stores 4 unsigned integers, unaligned (private)
+ */
+static inline void storeU64(uint64_t *p, u64x4 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+/**
+    Sum of doubles, two accumulators to hide the add latency (private)
+ */
+static double sumF64(const double *data, size_t length) {
+    f64x4 acc0 = { 0 };
+    f64x4 acc1 = { 0 };
+    size_t i = 0;
+    for (; i + 2 * LANES <= length; i += 2 * LANES) {
+        acc0 += loadF64(data + i);
+        acc1 += loadF64(data + i + LANES);
+    }
+    for (; i + LANES <= length; i += LANES) {
+        acc0 += loadF64(data + i);
+    }
+    acc0 += acc1;
+    double sum = (acc0[0] + acc0[1]) + (acc0[2] + acc0[3]);
+    for (; i < length; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+/**
+    Sum of integers, wrapping (private)
+ */
+static uint64_t sumU64(const uint64_t *data, size_t length) {
+    u64x4 acc0 = { 0 };
+    u64x4 acc1 = { 0 };
+    size_t i = 0;
+    for (; i + 2 * LANES <= length; i += 2 * LANES) {
+        acc0 += loadU64(data + i);
+        acc1 += loadU64(data + i + LANES);
+    }
+    for (; i + LANES <= length; i += LANES) {
+        acc0 += loadU64(data + i);
+    }
+    acc0 += acc1;
+    uint64_t sum = acc0[0] + acc0[1] + acc0[2] + acc0[3];
+    for (; i < length; i++) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+/**
+    Dot product of doubles (private)
+ */
+static double dotF64(const double *a, const double *b, size_t length) {
+    f64x4 acc0 = { 0 };
+    f64x4 acc1 = { 0 };
+    size_t i = 0;
+    for (; i + 2 * LANES <= length; i += 2 * LANES) {
+        acc0 += loadF64(a + i) * loadF64(b + i);
+        acc1 += loadF64(a + i + LANES) * loadF64(b + i + LANES);
+    }
+    for (; i + LANES <= length; i += LANES) {
+        acc0 += loadF64(a + i) * loadF64(b + i);
+    }
+    acc0 += acc1;
+    double sum = (acc0[0] + acc0[1]) + (acc0[2] + acc0[3]);
+    for (; i < length; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+    Dot product of integers, wrapping (private)
+ */
+static uint64_t dotU64(const uint64_t *a, const uint64_t *b, size_t length) {
+    u64x4 acc = { 0 };
+    size_t i = 0;
+    for (; i + LANES <= length; i += LANES) {
+        acc += loadU64(a + i) * loadU64(b + i);
+    }
+    uint64_t sum = acc[0] + acc[1] + acc[2] + acc[3];
+    for (; i < length; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+/**
+    Smallest or largest double, which element a NaN compares against decides whether it is kept (private)
+ @param data The elements, at least one
+ @param length The number of elements
+ @param largest 1 for the maximum
+ */
+static double extremeF64(const double *data, size_t length, int largest) {
+    size_t i = 0;
+    double result = data[0];
+    if (length >= LANES) {
+        f64x4 acc = loadF64(data);
+        for (i = LANES; i + LANES <= length; i += LANES) {
+            f64x4 v = loadF64(data + i);
+            s64x4 take = largest ? (v > acc) : (v < acc);
+            acc = (f64x4) (((s64x4) v & take) | ((s64x4) acc & ~take));
+        }
+        result = acc[0];
+        for (int lane = 1; lane < LANES; lane++) {
+            if (largest ? (acc[lane] > result) : (acc[lane] < result)) {
+                result = acc[lane];
+            }
+        }
+    }
+    for (; i < length; i++) {
+        if (largest ? (data[i] > result) : (data[i] < result)) {
+            result = data[i];
+        }
+    }
+    return result;
+}
+
+/**
+    Smallest or largest integer (private)
+ @param data The elements, at least one
+ @param length The number of elements
+ @param largest 1 for the maximum
+ */
+static int64_t extremeS64(const int64_t *data, size_t length, int largest) {
+    size_t i = 0;
+    int64_t result = data[0];
+    if (length >= LANES) {
+        s64x4 acc = loadS64(data);
+        for (i = LANES; i + LANES <= length; i += LANES) {
+            s64x4 v = loadS64(data + i);
+            s64x4 take = largest ? (v > acc) : (v < acc);
+            acc = (v & take) | (acc & ~take);
+        }
+        result = acc[0];
+        for (int lane = 1; lane < LANES; lane++) {
+            if (largest ? (acc[lane] > result) : (acc[lane] < result)) {
+                result = acc[lane];
+            }
+        }
+    }
+    for (; i < length; i++) {
+        if (largest ? (data[i] > result) : (data[i] < result)) {
+            result = data[i];
+        }
+    }
+    return result;
+}
+
+/**
+    Defines an elementwise kernel, out[i] = a[i] op b[i], or a[i] op b[0] when broadcast
+ */
+#define DEFINE_ELEMENTWISE(name, type, vtype, load, store, op) \
+    static void name(type *out, const type *a, const type *b, int broadcast, size_t length) { \
+        size_t i = 0; \
+        if (broadcast) { \
+            for (; i + LANES <= length; i += LANES) { \
+                store(out + i, load(a + i) op b[0]); \
+            } \
+            for (; i < length; i++) { \
+                out[i] = a[i] op b[0]; \
+            } \
+        } else { \
+            for (; i + LANES <= length; i += LANES) { \
+                store(out + i, load(a + i) op load(b + i)); \
+            } \
+            for (; i < length; i++) { \
+                out[i] = a[i] op b[i]; \
+            } \
+        } \
+    }
+
+DEFINE_ELEMENTWISE(addF64, double, f64x4, loadF64, storeF64, +)
+DEFINE_ELEMENTWISE(mulF64, double, f64x4, loadF64, storeF64, *)
+DEFINE_ELEMENTWISE(addU64, uint64_t, u64x4, loadU64, storeU64, +)
+DEFINE_ELEMENTWISE(mulU64, uint64_t, u64x4, loadU64, storeU64, *)
+
+/**
+    Defines a comparison kernel, out[i] = 1 if a[i] op b[i] (or b[0] when broadcast) and 0 otherwise
+    Vector comparisons give -1 for true, negating turns it into 1
+ */
+#define DEFINE_COMPARE(name, type, load, op) \
+    static void name(int64_t *out, const type *a, const type *b, int broadcast, size_t length) { \
+        size_t i = 0; \
+        if (broadcast) { \
+            for (; i + LANES <= length; i += LANES) { \
+                storeS64(out + i, -(load(a + i) op b[0])); \
+            } \
+            for (; i < length; i++) { \
+                out[i] = a[i] op b[0]; \
+            } \
+        } else { \
+            for (; i + LANES <= length; i += LANES) { \
+                storeS64(out + i, -(load(a + i) op load(b + i))); \
+            } \
+            for (; i < length; i++) { \
+                out[i] = a[i] op b[i]; \
+            } \
+        } \
+    }
+
+DEFINE_COMPARE(lessF64, double, loadF64, <)
+DEFINE_COMPARE(lessEQF64, double, loadF64, <=)
+DEFINE_COMPARE(greaterF64, double, loadF64, >)
+DEFINE_COMPARE(greaterEQF64, double, loadF64, >=)
+DEFINE_COMPARE(equalF64, double, loadF64, ==)
+DEFINE_COMPARE(lessS64, int64_t, loadS64, <)
+DEFINE_COMPARE(lessEQS64, int64_t, loadS64, <=)
+DEFINE_COMPARE(greaterS64, int64_t, loadS64, >)
+DEFINE_COMPARE(greaterEQS64, int64_t, loadS64, >=)
+DEFINE_COMPARE(equalS64, int64_t, loadS64, ==)
+
+typedef void (*F64Kernel)(double *out, const double *a, const double *b, int broadcast, size_t length);
+typedef void (*U64Kernel)(uint64_t *out, const uint64_t *a, const uint64_t *b, int broadcast, size_t length);
+typedef void (*F64Compare)(int64_t *out, const double *a, const double *b, int broadcast, size_t length);
+typedef void (*S64Compare)(int64_t *out, const int64_t *a, const int64_t *b, int broadcast, size_t length);
+
+// Vectors as SExprs
+
+/**
+    Allocates a vector, the elements are uninitialized (private)
+ @param type F64VECTOR or S64VECTOR
+ @param length The number of elements
+ @return The vector
+ */
+static SExpr allocVector(SExprType type, size_t length) {
+    size_t size = (length * sizeof(double) + VECTOR_ALIGNMENT - 1) / VECTOR_ALIGNMENT * VECTOR_ALIGNMENT;
+    Vector *vector = malloc(sizeof(Vector));
+    vector->length = length;
+    vector->f64 = aligned_alloc(VECTOR_ALIGNMENT, (size > 0) ? size : VECTOR_ALIGNMENT);
+    SExpr expr;
+    expr.type = type;
+    expr.vector = vector;
+    return expr;
+}
+
+/**
+    Converts a number to an f64vector element (private)
+ @param number An INT or REAL
+ @return The double
+ */
+static double toF64(SExpr number) {
+    if (number.type == INT) {
+        return (double) number.i;
+    } else if (number.type == REAL) {
+        return number.r;
+    }
+    fail("Expected a number for an f64vector, got %s", SExprName(number.type));
+}
+
+/**
+    Converts a number to an s64vector element (private)
+ @param number An INT
+ @return The integer
+ */
+static int64_t toS64(SExpr number) {
+    if (number.type != INT) {
+        fail("Expected an INT for an s64vector, got %s", SExprName(number.type));
+    }
+    return number.i;
+}
+
+/**
+    Checks that an SExpr is a vector (private)
+ @param expr The SExpr
+ @return The vector
+ */
+static Vector *checkVector(SExpr expr) {
+    if (!isVector(expr)) {
+        fail("Expected an f64vector or s64vector, got %s", SExprName(expr.type));
+    }
+    return expr.vector;
+}
+
+/**
+    Checks an index into a vector (private)
+ @param vector The vector
+ @param index The index
+ @return The index
+ */
+static size_t checkIndex(Vector *vector, SExpr index) {
+    if (index.type != INT || index.i < 0 || (uint64_t) index.i >= vector->length) {
+        fail("Vector index out of range");
+    }
+    return (size_t) index.i;
+}
+
+/**
+    Scalar or vector second operand (private)
+ */
+typedef union Operand Operand;
+union Operand {
+    double f64;
+    int64_t s64;
+};
+
+/**
+    Resolves the second operand of an elementwise operation, a vector of the same type and length or a number broadcast to every element (private)
+ @param vector The first operand
+ @param operand The second operand
+ @param scalar Storage for a number, converted to the vector's element type
+ @param broadcast Set to 1 for a number
+ @return The elements of the second operand
+ */
+static const void *secondOperand(SExpr vector, SExpr operand, Operand *scalar, int *broadcast) {
+    if (isVector(operand)) {
+        if (operand.type != vector.type || operand.vector->length != vector.vector->length) {
+            fail("Vectors must have the same type and length");
+        }
+        *broadcast = 0;
+        return operand.vector->f64;
+    }
+    *broadcast = 1;
+    if (vector.type == F64VECTOR) {
+        scalar->f64 = toF64(operand);
+    } else {
+        scalar->s64 = toS64(operand);
+    }
+    return scalar;
+}
+
+/**
+    Runs an elementwise kernel into a fresh vector (private)
+ @param argc The number of arguments, 2
+ @param argv The vector and the vector or number
+ @param f64 The f64vector kernel
+ @param s64 The s64vector kernel, on the bits as unsigned
+ @return The result vector
+ */
+static SExpr elementwise(int argc, SExpr *argv, F64Kernel f64, U64Kernel s64) {
+    check(argc == 2);
+    Vector *a = checkVector(argv[0]);
+    Operand scalar;
+    int broadcast;
+    const void *b = secondOperand(argv[0], argv[1], &scalar, &broadcast);
+    SExpr result = allocVector(argv[0].type, a->length);
+    if (argv[0].type == F64VECTOR) {
+        f64(result.vector->f64, a->f64, b, broadcast, a->length);
+    } else {
+        s64((uint64_t *) result.vector->s64, (const uint64_t *) a->s64, b, broadcast, a->length);
+    }
+    return result;
+}
+
+/**
+    Runs a comparison kernel into a fresh s64vector mask (private)
+ @param argc The number of arguments, 2
+ @param argv The vector and the vector or number
+ @param f64 The f64vector kernel
+ @param s64 The s64vector kernel
+ @return The mask
+ */
+static SExpr compare(int argc, SExpr *argv, F64Compare f64, S64Compare s64) {
+    check(argc == 2);
+    Vector *a = checkVector(argv[0]);
+    Operand scalar;
+    int broadcast;
+    const void *b = secondOperand(argv[0], argv[1], &scalar, &broadcast);
+    SExpr result = allocVector(S64VECTOR, a->length);
+    if (argv[0].type == F64VECTOR) {
+        f64(result.vector->s64, a->f64, b, broadcast, a->length);
+    } else {
+        s64(result.vector->s64, a->s64, b, broadcast, a->length);
+    }
+    return result;
+}
+
+/**
+    Fills a vector from an array of numbers (private)
+ @param type F64VECTOR or S64VECTOR
+ @param count The number of elements
+ @param items The numbers
+ @return The vector
+ */
+static SExpr arrayToVector(SExprType type, size_t count, const SExpr *items) {
+    SExpr vector = allocVector(type, count);
+    for (size_t i = 0; i < count; i++) {
+        if (type == F64VECTOR) {
+            vector.vector->f64[i] = toF64(items[i]);
+        } else {
+            vector.vector->s64[i] = toS64(items[i]);
+        }
+    }
+    return vector;
+}
+
+/**
+    Makes a vector with every element set (private)
+ @param type F64VECTOR or S64VECTOR
+ @param argc The number of arguments, 1 or 2
+ @param argv The length and the optional fill
+ @return The vector
+ */
+static SExpr makeFilledVector(SExprType type, int argc, SExpr *argv) {
+    check(argc == 1 || argc == 2);
+    check(argv[0].type == INT && argv[0].i >= 0);
+    SExpr fill = (argc == 2) ? argv[1] : intToSExpr(0);
+    SExpr vector = allocVector(type, (size_t) argv[0].i);
+    for (size_t i = 0; i < vector.vector->length; i++) {
+        if (type == F64VECTOR) {
+            vector.vector->f64[i] = toF64(fill);
+        } else {
+            vector.vector->s64[i] = toS64(fill);
+        }
+    }
+    return vector;
+}
+
+/**
+    Makes a vector from a list (private)
+ @param type F64VECTOR or S64VECTOR
+ @param list The list of numbers
+ @return The vector
+ */
+static SExpr listToVector(SExprType type, SExpr list) {
+    size_t count = (size_t) length(list).i;
+    SExpr vector = allocVector(type, count);
+    size_t i = 0;
+    for (SExpr current = list; isCONS(current); current = uncheckedCdr(current), i++) {
+        if (type == F64VECTOR) {
+            vector.vector->f64[i] = toF64(uncheckedCar(current));
+        } else {
+            vector.vector->s64[i] = toS64(uncheckedCar(current));
+        }
+    }
+    return vector;
+}
+
+/**
+    An element as an SExpr (private)
+ @param vector The vector
+ @param index The index
+ @return A REAL or INT
+ */
+static SExpr elementAt(SExpr vector, size_t index) {
+    return (vector.type == F64VECTOR) ? realToSExpr(vector.vector->f64[index]) : intToSExpr(vector.vector->s64[index]);
+}
+
+SExpr vectorSum(SExpr vector) {
+    Vector *v = checkVector(vector);
+    if (vector.type == F64VECTOR) {
+        return realToSExpr(sumF64(v->f64, v->length));
+    }
+    return intToSExpr((int64_t) sumU64((const uint64_t *) v->s64, v->length));
+}
+
+SExpr evalF64Vector(int argc, SExpr *argv) {
+    return arrayToVector(F64VECTOR, (size_t) argc, argv);
+}
+
+SExpr evalS64Vector(int argc, SExpr *argv) {
+    return arrayToVector(S64VECTOR, (size_t) argc, argv);
+}
+
+SExpr evalMakeF64Vector(int argc, SExpr *argv) {
+    return makeFilledVector(F64VECTOR, argc, argv);
+}
+
+SExpr evalMakeS64Vector(int argc, SExpr *argv) {
+    return makeFilledVector(S64VECTOR, argc, argv);
+}
+
+SExpr evalListToF64Vector(int argc, SExpr *argv) {
+    check(argc == 1);
+    return listToVector(F64VECTOR, argv[0]);
+}
+
+SExpr evalListToS64Vector(int argc, SExpr *argv) {
+    check(argc == 1);
+    return listToVector(S64VECTOR, argv[0]);
+}
+
+SExpr evalIsF64Vector(int argc, SExpr *argv) {
+    check(argc == 1);
+    return (argv[0].type == F64VECTOR) ? TObj : NILObj;
+}
+
+SExpr evalIsS64Vector(int argc, SExpr *argv) {
+    check(argc == 1);
+    return (argv[0].type == S64VECTOR) ? TObj : NILObj;
+}
+
+SExpr evalVectorToList(int argc, SExpr *argv) {
+    check(argc == 1);
+    Vector *vector = checkVector(argv[0]);
+    SExpr list = NILObj;
+    for (size_t i = vector->length; i > 0; i--) {
+        list = consToSExpr(elementAt(argv[0], i - 1), list);
+    }
+    return list;
+}
+
+SExpr evalVectorLength(int argc, SExpr *argv) {
+    check(argc == 1);
+    return intToSExpr((int64_t) checkVector(argv[0])->length);
+}
+
+SExpr evalVectorRef(int argc, SExpr *argv) {
+    check(argc == 2);
+    return elementAt(argv[0], checkIndex(checkVector(argv[0]), argv[1]));
+}
+
+SExpr evalVectorSet(int argc, SExpr *argv) {
+    check(argc == 3);
+    Vector *vector = checkVector(argv[0]);
+    size_t index = checkIndex(vector, argv[1]);
+    if (argv[0].type == F64VECTOR) {
+        vector->f64[index] = toF64(argv[2]);
+    } else {
+        vector->s64[index] = toS64(argv[2]);
+    }
+    return NILObj;
+}
+
+SExpr evalVectorSum(int argc, SExpr *argv) {
+    check(argc == 1);
+    return vectorSum(argv[0]);
+}
+
+SExpr evalVectorDot(int argc, SExpr *argv) {
+    check(argc == 2);
+    Vector *a = checkVector(argv[0]);
+    Vector *b = checkVector(argv[1]);
+    if (argv[0].type != argv[1].type || a->length != b->length) {
+        fail("Vectors must have the same type and length");
+    }
+    if (argv[0].type == F64VECTOR) {
+        return realToSExpr(dotF64(a->f64, b->f64, a->length));
+    }
+    return intToSExpr((int64_t) dotU64((const uint64_t *) a->s64, (const uint64_t *) b->s64, a->length));
+}
+
+/**
+    vector-min and vector-max (private)
+ @param argc The number of arguments, 1
+ @param argv The vector
+ @param largest 1 for the maximum
+ @return The element
+ */
+static SExpr vectorExtreme(int argc, SExpr *argv, int largest) {
+    check(argc == 1);
+    Vector *vector = checkVector(argv[0]);
+    if (vector->length == 0) {
+        fail("Empty vector has no %s", largest ? "maximum" : "minimum");
+    }
+    if (argv[0].type == F64VECTOR) {
+        return realToSExpr(extremeF64(vector->f64, vector->length, largest));
+    }
+    return intToSExpr(extremeS64(vector->s64, vector->length, largest));
+}
+
+SExpr evalVectorMin(int argc, SExpr *argv) {
+    return vectorExtreme(argc, argv, 0);
+}
+
+SExpr evalVectorMax(int argc, SExpr *argv) {
+    return vectorExtreme(argc, argv, 1);
+}
+
+SExpr evalVectorAdd(int argc, SExpr *argv) {
+    return elementwise(argc, argv, addF64, addU64);
+}
+
+SExpr evalVectorMul(int argc, SExpr *argv) {
+    return elementwise(argc, argv, mulF64, mulU64);
+}
+
+SExpr evalVectorScale(int argc, SExpr *argv) {
+    check(argc == 2);
+    check(!isVector(argv[1]));
+    return elementwise(argc, argv, mulF64, mulU64);
+}
+
+SExpr evalVectorLess(int argc, SExpr *argv) {
+    return compare(argc, argv, lessF64, lessS64);
+}
+
+SExpr evalVectorLessEQ(int argc, SExpr *argv) {
+    return compare(argc, argv, lessEQF64, lessEQS64);
+}
+
+SExpr evalVectorGreater(int argc, SExpr *argv) {
+    return compare(argc, argv, greaterF64, greaterS64);
+}
+
+SExpr evalVectorGreaterEQ(int argc, SExpr *argv) {
+    return compare(argc, argv, greaterEQF64, greaterEQS64);
+}
+
+SExpr evalVectorEQ(int argc, SExpr *argv) {
+    return compare(argc, argv, equalF64, equalS64);
+}
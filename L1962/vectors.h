@@ -0,0 +1,222 @@
+//
+//  vectors.h
+//      Homogeneous numeric vectors, f64vector and s64vector, with data-parallel kernels for the bulk operations
+//  L1962
+//
+
+#ifndef vectors_h
+#define vectors_h
+
+#include "SExpr.h"
+
+#define VECTOR_ALIGNMENT (4 * sizeof(double)) // Vector data starts on this boundary, the width of the kernels
+
+/**
+    Checks if an SExpr is an f64vector or s64vector
+ @param expr The SExpr
+ @return 1 if it is
+ */
+inline int isVector(SExpr expr) {
+    return expr.type == F64VECTOR || expr.type == S64VECTOR;
+}
+
+/**
+    Adds up a vector
+ @param vector The f64vector or s64vector
+ @return The sum, a REAL for an f64vector and an INT (wrapping) for an s64vector
+ */
+SExpr vectorSum(SExpr vector);
+
+/**
+    f64vector builtin, (f64vector numbers...)
+ @param argc The number of elements
+ @param argv The numbers, INT or REAL
+ @return The f64vector
+ */
+SExpr evalF64Vector(int argc, SExpr *argv);
+
+/**
+    s64vector builtin, (s64vector integers...)
+ @param argc The number of elements
+ @param argv The integers
+ @return The s64vector
+ */
+SExpr evalS64Vector(int argc, SExpr *argv);
+
+/**
+    make-f64vector builtin, (make-f64vector length [fill])
+ @param argc The number of arguments, 1 or 2
+ @param argv The length and the optional fill, 0 by default
+ @return The f64vector
+ */
+SExpr evalMakeF64Vector(int argc, SExpr *argv);
+
+/**
+    make-s64vector builtin, (make-s64vector length [fill])
+ @param argc The number of arguments, 1 or 2
+ @param argv The length and the optional fill, 0 by default
+ @return The s64vector
+ */
+SExpr evalMakeS64Vector(int argc, SExpr *argv);
+
+/**
+    list->f64vector builtin, (list->f64vector list)
+ @param argc The number of arguments, 1
+ @param argv The list of numbers
+ @return The f64vector
+ */
+SExpr evalListToF64Vector(int argc, SExpr *argv);
+
+/**
+    list->s64vector builtin, (list->s64vector list)
+ @param argc The number of arguments, 1
+ @param argv The list of integers
+ @return The s64vector
+ */
+SExpr evalListToS64Vector(int argc, SExpr *argv);
+
+/**
+    f64vector? builtin, (f64vector? value)
+ @param argc The number of arguments, 1
+ @param argv The value
+ @return true if it is an f64vector
+ */
+SExpr evalIsF64Vector(int argc, SExpr *argv);
+
+/**
+    s64vector? builtin, (s64vector? value)
+ @param argc The number of arguments, 1
+ @param argv The value
+ @return true if it is an s64vector
+ */
+SExpr evalIsS64Vector(int argc, SExpr *argv);
+
+/**
+    f64vector->list and s64vector->list builtin, (f64vector->list vector)
+ @param argc The number of arguments, 1
+ @param argv The vector
+ @return A fresh list of the elements
+ */
+SExpr evalVectorToList(int argc, SExpr *argv);
+
+/**
+    f64vector-length and s64vector-length builtin, (f64vector-length vector)
+ @param argc The number of arguments, 1
+ @param argv The vector
+ @return The number of elements as an INT
+ */
+SExpr evalVectorLength(int argc, SExpr *argv);
+
+/**
+    f64vector-ref and s64vector-ref builtin, (f64vector-ref vector index)
+ @param argc The number of arguments, 2
+ @param argv The vector and the zero based index
+ @return The element
+ */
+SExpr evalVectorRef(int argc, SExpr *argv);
+
+/**
+    f64vector-set! and s64vector-set! builtin, (f64vector-set! vector index value)
+ @param argc The number of arguments, 3
+ @param argv The vector, the zero based index and the value
+ @return NIL
+ */
+SExpr evalVectorSet(int argc, SExpr *argv);
+
+/**
+    vector-sum builtin, (vector-sum vector)
+ @param argc The number of arguments, 1
+ @param argv The vector
+ @return The sum, a REAL for an f64vector and an INT for an s64vector
+ */
+SExpr evalVectorSum(int argc, SExpr *argv);
+
+/**
+    vector-dot builtin, (vector-dot a b), both of the same type and length
+ @param argc The number of arguments, 2
+ @param argv The vectors
+ @return The dot product
+ */
+SExpr evalVectorDot(int argc, SExpr *argv);
+
+/**
+    vector-min builtin, (vector-min vector)
+ @param argc The number of arguments, 1
+ @param argv The vector, not empty
+ @return The smallest element
+ */
+SExpr evalVectorMin(int argc, SExpr *argv);
+
+/**
+    vector-max builtin, (vector-max vector)
+ @param argc The number of arguments, 1
+ @param argv The vector, not empty
+ @return The largest element
+ */
+SExpr evalVectorMax(int argc, SExpr *argv);
+
+/**
+    vector-add builtin, (vector-add a b), elementwise into a fresh vector, b may be a vector or a number
+ @param argc The number of arguments, 2
+ @param argv The vector and the vector or number to add
+ @return The sum vector
+ */
+SExpr evalVectorAdd(int argc, SExpr *argv);
+
+/**
+    vector-mul builtin, (vector-mul a b), elementwise into a fresh vector, b may be a vector or a number
+ @param argc The number of arguments, 2
+ @param argv The vector and the vector or number to multiply by
+ @return The product vector
+ */
+SExpr evalVectorMul(int argc, SExpr *argv);
+
+/**
+    vector-scale builtin, (vector-scale vector factor)
+ @param argc The number of arguments, 2
+ @param argv The vector and the number
+ @return A fresh scaled vector
+ */
+SExpr evalVectorScale(int argc, SExpr *argv);
+
+/**
+    vector< builtin, (vector< a b), b may be a vector or a number
+ @param argc The number of arguments, 2
+ @param argv The vector and what it is compared to
+ @return An s64vector mask, 1 where the comparison holds and 0 elsewhere
+ */
+SExpr evalVectorLess(int argc, SExpr *argv);
+
+/**
+    vector<= builtin, (vector<= a b), b may be a vector or a number
+ @param argc The number of arguments, 2
+ @param argv The vector and what it is compared to
+ @return An s64vector mask, 1 where the comparison holds and 0 elsewhere
+ */
+SExpr evalVectorLessEQ(int argc, SExpr *argv);
+
+/**
+    vector> builtin, (vector> a b), b may be a vector or a number
+ @param argc The number of arguments, 2
+ @param argv The vector and what it is compared to
+ @return An s64vector mask, 1 where the comparison holds and 0 elsewhere
+ */
+SExpr evalVectorGreater(int argc, SExpr *argv);
+
+/**
+    vector>= builtin, (vector>= a b), b may be a vector or a number
+ @param argc The number of arguments, 2
+ @param argv The vector and what it is compared to
+ @return An s64vector mask, 1 where the comparison holds and 0 elsewhere
+ */
+SExpr evalVectorGreaterEQ(int argc, SExpr *argv);
+
+/**
+    vector= builtin, (vector= a b), b may be a vector or a number
+ @param argc The number of arguments, 2
+ @param argv The vector and what it is compared to
+ @return An s64vector mask, 1 where the comparison holds and 0 elsewhere
+ */
+SExpr evalVectorEQ(int argc, SExpr *argv);
+
+#endif /* vectors_h */
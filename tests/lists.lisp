@@ -0,0 +1,158 @@
+; The native list library (L1962/lists.c) against the init.lisp definitions it replaced
+; Run from the repository root, after init.lisp has loaded: l1962 tests/lists.lisp
+; Every same check prints (ok name), failures is 0 at the end, and the last section prints caught twice per pair
+
+(define failures 0)
+
+(define (same name native lisp)
+	(if (equal? (sexpr->string native) (sexpr->string lisp))
+		(list 'ok name)
+		(begin
+			(set! failures (+ failures 1))
+			(list 'FAIL name native lisp))))
+
+; The definitions removed from init.lisp, renamed
+
+(define (lisp-length x)
+	(if (nil? x)
+		0
+		(+ 1 (lisp-length (cdr x)))))
+
+(define (lisp-list . x) x)
+
+(define (lisp-list* . lst)
+	(if (nil? (cdr lst))
+		(car lst)
+		(cons (car lst) (lisp-list*-helper (cdr lst)))))
+
+(define (lisp-list*-helper lst)
+	(if (nil? (cdr lst))
+		(car lst)
+		(cons (car lst) (lisp-list*-helper (cdr lst)))))
+
+(define (lisp-last x)
+	(if (nil? x)
+		()
+		(if (cons? (cdr x))
+			(lisp-last (cdr x))
+			x)))
+
+(defun lisp-max (x y)
+	(if (> x y)
+		x
+		y))
+
+(defun lisp-min (x y)
+	(if (> x y)
+		y
+		x))
+
+(defun lisp-caar (lst)
+	(car (car lst)))
+
+(defun lisp-cadr (lst)
+	(car (cdr lst)))
+
+(defun lisp-cddr (lst)
+	(cdr (cdr lst)))
+
+(defun lisp-cdar (lst)
+	(cdr (car lst)))
+
+(defun lisp-avg (lst)
+	(/ (apply + lst) (lisp-length lst)))
+
+(defun lisp-merge-list (x y)
+	(if (nil? x)
+		y
+		(cons (car x) (lisp-merge-list (cdr x) y))))
+
+; nth was never in init.lisp, this is the Common Lisp meaning it follows, NIL past the end
+
+(defun lisp-nth (n lst)
+	(if (nil? lst)
+		()
+		(if (= n 0)
+			(car lst)
+			(lisp-nth (- n 1) (cdr lst)))))
+
+(define long (let loop ((i 0) (acc ())) (if (= i 500) acc (loop (+ i 1) (cons i acc)))))
+
+(same 'length-empty (length ()) (lisp-length ()))
+(same 'length-one (length '(a)) (lisp-length '(a)))
+(same 'length-nested (length '((1 2) (3) ())) (lisp-length '((1 2) (3) ())))
+(same 'length-long (length long) (lisp-length long))
+
+(same 'list-empty (list) (lisp-list))
+(same 'list-items (list 1 'b "c" '(d)) (lisp-list 1 'b "c" '(d)))
+
+(same 'list*-one (list* 1) (lisp-list* 1))
+(same 'list*-empty (list* ()) (lisp-list* ()))
+(same 'list*-spread (list* 1 2 '(3 4)) (lisp-list* 1 2 '(3 4)))
+(same 'list*-improper (list* 1 2 3) (lisp-list* 1 2 3))
+(same 'list*-empty-tail (list* 1 ()) (lisp-list* 1 ()))
+
+(same 'last-empty (last ()) (lisp-last ()))
+(same 'last-one (last '(1)) (lisp-last '(1)))
+(same 'last-many (last '(1 2 3)) (lisp-last '(1 2 3)))
+(same 'last-improper (last '(1 2 . 3)) (lisp-last '(1 2 . 3)))
+(same 'last-long (last long) (lisp-last long))
+
+(same 'max-int (max 3 7) (lisp-max 3 7))
+(same 'max-real (max 2.5 -1.5) (lisp-max 2.5 -1.5))
+(same 'max-tie-int-real (max 1 1.0) (lisp-max 1 1.0))
+(same 'max-tie-real-int (max 1.0 1) (lisp-max 1.0 1))
+(same 'min-int (min 3 7) (lisp-min 3 7))
+(same 'min-negative (min -4 2.0) (lisp-min -4 2.0))
+(same 'min-tie-int-real (min 1 1.0) (lisp-min 1 1.0))
+(same 'min-tie-real-int (min 1.0 1) (lisp-min 1.0 1))
+
+(same 'caar (caar '((1 2) 3)) (lisp-caar '((1 2) 3)))
+(same 'cadr (cadr '(1 2 3)) (lisp-cadr '(1 2 3)))
+(same 'cddr (cddr '(1 2 3)) (lisp-cddr '(1 2 3)))
+(same 'cddr-improper (cddr '(1 2 . 3)) (lisp-cddr '(1 2 . 3)))
+(same 'cdar (cdar '((1 . 2) 3)) (lisp-cdar '((1 . 2) 3)))
+
+(same 'avg-int (avg '(1 2 3 4)) (lisp-avg '(1 2 3 4)))
+(same 'avg-exact (avg '(2 4 6)) (lisp-avg '(2 4 6)))
+(same 'avg-mixed (avg '(1 2.0)) (lisp-avg '(1 2.0)))
+(same 'avg-one (avg '(5)) (lisp-avg '(5)))
+(same 'avg-empty (avg ()) (lisp-avg ()))
+
+(same 'merge-list-empty (merge-list () ()) (lisp-merge-list () ()))
+(same 'merge-list-empty-first (merge-list () '(1 2)) (lisp-merge-list () '(1 2)))
+(same 'merge-list-empty-second (merge-list '(1 2) ()) (lisp-merge-list '(1 2) ()))
+(same 'merge-list-atom-tail (merge-list '(1 2) 5) (lisp-merge-list '(1 2) 5))
+(same 'merge-list-lists (merge-list '(1 2) '(3 (4))) (lisp-merge-list '(1 2) '(3 (4))))
+
+(same 'nth-first (nth 0 '(a b c)) (lisp-nth 0 '(a b c)))
+(same 'nth-last (nth 2 '(a b c)) (lisp-nth 2 '(a b c)))
+(same 'nth-past-end (nth 3 '(a b c)) (lisp-nth 3 '(a b c)))
+(same 'nth-far-past-end (nth 100 '(a b c)) (lisp-nth 100 '(a b c)))
+(same 'nth-empty (nth 0 ()) (lisp-nth 0 ()))
+(same 'nth-long (nth 250 long) (lisp-nth 250 long))
+
+failures
+
+; Both of each pair fail, native first
+
+(length '(1 2 . 3))
+(lisp-length '(1 2 . 3))
+
+(merge-list '(1 . 2) '(3))
+(lisp-merge-list '(1 . 2) '(3))
+
+(last 5)
+(lisp-last 5)
+
+(cadr '(1))
+(lisp-cadr '(1))
+
+(cddr '(1))
+(lisp-cddr '(1))
+
+(nth 1 '(a . b))
+(lisp-nth 1 '(a . b))
+
+(nth -1 '(a b))
+(nth 'one '(a b))
@@ -0,0 +1,76 @@
+; Loop variables seen by closures and futures made in the loop keep the value of their own iteration
+; Run from the repository root, after init.lisp has loaded: l1962 tests/loops.lisp
+; Every same check prints (ok name) and failures is 0 at the end, run it a few times for the futures
+
+(define failures 0)
+
+(define (same name actual expected)
+	(if (equal? actual expected)
+		(list 'ok name)
+		(begin
+			(set! failures (+ failures 1))
+			(list 'FAIL name actual expected))))
+
+(define (call-all fs) (map (lambda (f) (f)) fs))
+
+; Closures
+
+(same 'named-let-closures
+	(call-all (let loop ((i 0) (acc ())) (if (< i 3) (loop (+ i 1) (cons (lambda () i) acc)) acc)))
+	'(2 1 0))
+
+(same 'named-let-closures-under-let
+	(let loop ((i 0) (acc ()))
+		(let ((sq (* i i)))
+			(if (< i 3) (loop (+ i 1) (cons (lambda () (list i sq)) acc)) (call-all acc))))
+	'((2 4) (1 1) (0 0)))
+
+(define (closures-in-function n)
+	(let loop ((i 0) (fs ())) (if (= i n) (call-all fs) (loop (+ i 1) (cons (lambda () i) fs)))))
+(same 'named-let-closures-in-function (closures-in-function 4) '(3 2 1 0))
+
+(define gs ())
+(dotimes (i 4) (set! gs (cons (lambda () i) gs)))
+(same 'dotimes-closures (call-all gs) '(3 2 1 0))
+
+(define hs ())
+(dolist (x '(a b c)) (set! hs (cons (lambda () x) hs)))
+(same 'dolist-closures (call-all hs) '(c b a))
+
+(define ks ())
+(same 'do-closures
+	(do ((i 0 (+ i 1)) (j 10)) ((= i 3) (call-all ks))
+		(set! ks (cons (lambda () (list i j)) ks))
+		(set! j (+ j 1)))
+	'((2 13) (1 12) (0 11)))
+
+(define nested ())
+(dotimes (i 2) (dotimes (j 2) (set! nested (cons (lambda () (list i j)) nested))))
+(same 'nested-dotimes-closures (call-all nested) '((1 1) (1 0) (0 1) (0 0)))
+
+; Futures
+
+(define fs ())
+(dotimes (i 6) (set! fs (cons (future (* i i)) fs)))
+(same 'dotimes-futures (map touch fs) '(25 16 9 4 1 0))
+
+(define ds ())
+(dolist (x '(1 2 3 4)) (set! ds (cons (future (+ x 100)) ds)))
+(same 'dolist-futures (map touch ds) '(104 103 102 101))
+
+(define ps ())
+(let loop ((i 0)) (when (< i 4) (set! ps (cons (future (list i)) ps)) (loop (+ i 1))))
+(same 'named-let-futures (map touch ps) '((3) (2) (1) (0)))
+
+(same 'do-futures
+	(do ((i 0 (+ i 1)) (out () (cons (future (* 10 i)) out))) ((= i 4) (map touch out)))
+	'(30 20 10 0))
+
+; Loops that capture nothing still update in place
+
+(same 'named-let-sum (let loop ((i 0) (s 0)) (if (< i 100000) (loop (+ i 1) (+ s i)) s)) 4999950000)
+(same 'dotimes-result (dotimes (i 3 i)) 3)
+(same 'dotimes-empty-result (dotimes (i 0 i)) 0)
+(same 'do-sum (do ((i 0 (+ i 1)) (s 0 (+ s i))) ((= i 5) s)) 10)
+
+failures